@@ -0,0 +1,38 @@
+// bench/bench_memory.cpp
+//
+// Reports heap bytes per entry for full caches of a few key/value shapes.
+#include "../src/hashtable.hpp"
+#include "../src/inline_string.hpp"
+#include "../src/lru.hpp"
+#include "../src/sampled_lru.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+template <typename Cache, typename MakeKey>
+void report(const char* name, size_t capacity, MakeKey make_key) {
+    Cache cache(capacity);
+    for (size_t i = 0; i < capacity; ++i) {
+        cache.put(make_key(i), {});
+    }
+    std::printf("%-40s %10zu entries %8.1f bytes/entry\n", name, cache.size(),
+                static_cast<double>(cache.memory_usage()) / static_cast<double>(cache.size()));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t capacity = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+    auto integer_key = [](size_t i) { return static_cast<uint64_t>(i) * 0x9E3779B97F4A7C15ULL; };
+    auto short_key = [](size_t i) { return InlineString<15>("k" + std::to_string(i)); };
+
+    report<LRUCache<uint64_t, uint64_t>>("LRUCache<uint64_t, uint64_t>", capacity, integer_key);
+    report<LRUCache<uint32_t, uint32_t>>("LRUCache<uint32_t, uint32_t>", capacity,
+                                         [](size_t i) { return static_cast<uint32_t>(i * 2654435761u); });
+    report<LRUCache<InlineString<15>, uint64_t>>("LRUCache<InlineString<15>, uint64_t>", capacity, short_key);
+    report<SampledLRUCache<uint64_t, uint64_t>>("SampledLRUCache<uint64_t, uint64_t>", capacity, integer_key);
+    return 0;
+}
@@ -0,0 +1,386 @@
+// bench/bench_stress.cpp
+//
+// Multithreaded stress benchmark. Drives N threads against a cache with a
+// configurable read/write mix and key distribution, records the latency of
+// every operation in a log-linear histogram and prints throughput and
+// p50/p99/p99.9/max per thread count, i.e. a scaling curve per cache.
+//
+// Caches:
+//   mutex       LRUCache behind one mutex (the baseline)
+//   sharded     16 LRUCaches with a mutex each, picked by key hash
+//   concurrent  ConcurrentHashTable: lock-free reads, one writer at a time,
+//               no eviction; an upper bound for what lock-free reads buy
+//
+// Usage: benchStress [--threads=1,2,4,8] [--ops=1000000] [--reads=0.9]
+//                    [--keys=1000000] [--capacity=100000]
+//                    [--dist=zipf|uniform] [--zipf=0.99]
+//                    [--cache=all|mutex|sharded|concurrent]
+//
+// --ops is per thread. Latencies include two clock reads, typically a few
+// tens of nanoseconds.
+#include "../src/concurrent_hashtable.hpp"
+#include "../src/lru.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Latency histogram in the style of HdrHistogram: values below kSub are
+// counted exactly, larger ones in kSub buckets per power of two, so any
+// reported value is within 1/kSub (about 3%) of the true one
+class LatencyHistogram {
+public:
+    static constexpr int kSubBits = 5;
+    static constexpr uint64_t kSub = uint64_t(1) << kSubBits;
+
+    LatencyHistogram() : counts_((64 - kSubBits + 1) * kSub, 0) {}
+
+    void record(uint64_t ns) {
+        ++counts_[bucket(ns)];
+        ++total_;
+        max_ = std::max(max_, ns);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        total_ += other.total_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    // Smallest recorded value such that a fraction `p` of all values are no
+    // larger, up to the bucket's resolution
+    uint64_t percentile(double p) const {
+        if (total_ == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(std::ceil(p * static_cast<double>(total_)));
+        rank = std::max<uint64_t>(rank, 1);
+        uint64_t seen = 0;
+        for (size_t b = 0; b < counts_.size(); ++b) {
+            seen += counts_[b];
+            if (seen >= rank) {
+                return std::min(highest_in(b), max_);
+            }
+        }
+        return max_;
+    }
+
+    uint64_t count() const { return total_; }
+    uint64_t max() const { return max_; }
+
+private:
+    std::vector<uint64_t> counts_;
+    uint64_t total_ = 0;
+    uint64_t max_ = 0;
+
+    static size_t bucket(uint64_t v) {
+        if (v < kSub) return static_cast<size_t>(v);
+        int shift = static_cast<int>(std::bit_width(v)) - 1 - kSubBits;
+        return static_cast<size_t>((shift + 1) * kSub + ((v >> shift) - kSub));
+    }
+
+    static uint64_t highest_in(size_t b) {
+        if (b < kSub) return b;
+        int shift = static_cast<int>(b / kSub) - 1;
+        return ((kSub + b % kSub + 1) << shift) - 1;
+    }
+};
+
+struct Options {
+    std::vector<size_t> threads;
+    size_t ops = 1000000;
+    double reads = 0.9;
+    size_t keys = 1000000;
+    size_t capacity = 100000;
+    bool zipf = true;
+    double zipf_s = 0.99;
+    std::string cache = "all";
+};
+
+// Key sources. Keys are ranks scrambled by an odd multiplier, so that hot
+// keys do not sit next to each other in the table.
+uint64_t key_of(uint64_t rank) {
+    return rank * 0x9E3779B97F4A7C15ULL;
+}
+
+class KeyDistribution {
+public:
+    explicit KeyDistribution(const Options& options) : keys_(options.keys), zipf_(options.zipf) {
+        if (zipf_) {
+            cdf_.resize(keys_);
+            double sum = 0;
+            for (size_t i = 0; i < keys_; ++i) {
+                sum += 1.0 / std::pow(static_cast<double>(i + 1), options.zipf_s);
+                cdf_[i] = sum;
+            }
+            for (double& c : cdf_) {
+                c /= sum;
+            }
+        }
+    }
+
+    uint64_t rank(std::mt19937_64& rng) const {
+        if (!zipf_) {
+            return rng() % keys_;
+        }
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        return static_cast<uint64_t>(std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin());
+    }
+
+private:
+    size_t keys_;
+    bool zipf_;
+    std::vector<double> cdf_;
+};
+
+// Cache adapters: bool get(key, value&) and void put(key, value), safe to
+// call from any thread
+class MutexCache {
+public:
+    explicit MutexCache(size_t capacity) : cache_(capacity) {}
+
+    bool get(uint64_t key, uint64_t& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const uint64_t* found = cache_.find(key);
+        if (!found) return false;
+        value = *found;
+        return true;
+    }
+
+    void put(uint64_t key, uint64_t value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cache_.put(key, value);
+    }
+
+private:
+    std::mutex mutex_;
+    LRUCache<uint64_t, uint64_t> cache_;
+};
+
+class ShardedCache {
+public:
+    static constexpr size_t kShards = 16;
+
+    explicit ShardedCache(size_t capacity) {
+        for (size_t i = 0; i < kShards; ++i) {
+            shards_.push_back(std::make_unique<Shard>((capacity + kShards - 1) / kShards));
+        }
+    }
+
+    bool get(uint64_t key, uint64_t& value) { return shard(key).get(key, value); }
+    void put(uint64_t key, uint64_t value) { shard(key).put(key, value); }
+
+private:
+    struct alignas(64) Shard : MutexCache {
+        using MutexCache::MutexCache;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    Shard& shard(uint64_t key) {
+        return *shards_[(key ^ (key >> 29)) * 0xBF58476D1CE4E5B9ULL >> 60];
+    }
+};
+
+class ConcurrentCache {
+public:
+    explicit ConcurrentCache(size_t capacity) : table_(capacity * 2) {}
+
+    bool get(uint64_t key, uint64_t& value) {
+        return table_.visit(key, [&](const uint64_t& found) { value = found; });
+    }
+
+    void put(uint64_t key, uint64_t value) { table_.insert(key, value); }
+
+private:
+    ConcurrentHashTable<uint64_t, uint64_t> table_;
+};
+
+struct alignas(64) RunResult { // Per thread; kept off each other's cache lines
+    double seconds = 0;
+    uint64_t hits = 0;
+    LatencyHistogram get;
+    LatencyHistogram put;
+};
+
+template <typename Cache>
+RunResult run(const Options& options, const KeyDistribution& keys, size_t threads) {
+    Cache cache(options.capacity);
+    for (size_t rank = 0; rank < options.capacity && rank < options.keys; ++rank) {
+        cache.put(key_of(rank), rank);
+    }
+
+    // Operations are generated up front so the timed loop does no RNG work
+    constexpr size_t kMaxPlanned = size_t(1) << 20;
+    size_t planned = std::min(options.ops, kMaxPlanned);
+    struct Plan {
+        std::vector<uint64_t> keys;
+        std::vector<uint8_t> is_read;
+    };
+    std::vector<Plan> plans(threads);
+    for (size_t t = 0; t < threads; ++t) {
+        std::mt19937_64 rng(12345 + t);
+        std::bernoulli_distribution read(options.reads);
+        plans[t].keys.resize(planned);
+        plans[t].is_read.resize(planned);
+        for (size_t i = 0; i < planned; ++i) {
+            plans[t].keys[i] = key_of(keys.rank(rng));
+            plans[t].is_read[i] = read(rng);
+        }
+    }
+
+    std::vector<RunResult> partial(threads);
+    std::atomic<size_t> ready{ 0 };
+    std::atomic<bool> go{ false };
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            const Plan& plan = plans[t];
+            RunResult& result = partial[t];
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (size_t i = 0; i < options.ops; ++i) {
+                size_t at = i % planned;
+                uint64_t key = plan.keys[at];
+                auto start = std::chrono::steady_clock::now();
+                if (plan.is_read[at]) {
+                    uint64_t value;
+                    bool hit = cache.get(key, value);
+                    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+                    result.get.record(static_cast<uint64_t>(ns.count()));
+                    result.hits += hit;
+                }
+                else {
+                    cache.put(key, i);
+                    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+                    result.put.record(static_cast<uint64_t>(ns.count()));
+                }
+            }
+        });
+    }
+    while (ready.load() != threads) {
+        std::this_thread::yield();
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    RunResult total;
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (const RunResult& result : partial) {
+        total.hits += result.hits;
+        total.get.merge(result.get);
+        total.put.merge(result.put);
+    }
+    return total;
+}
+
+void print_header(const char* name, const Options& options) {
+    char dist[32] = "uniform";
+    if (options.zipf) {
+        std::snprintf(dist, sizeof(dist), "zipf %.2f", options.zipf_s);
+    }
+    std::printf("\n%s: reads %.0f%%, %s, %zu keys, capacity %zu, %zu ops/thread\n", name, options.reads * 100, dist,
+                options.keys, options.capacity, options.ops);
+    std::printf("%7s %9s %6s | %26s | %26s\n", "", "", "", "get latency (ns)", "put latency (ns)");
+    std::printf("%7s %9s %6s | %5s %6s %6s %7s | %5s %6s %6s %7s\n", "threads", "Mops/s", "hit%", "p50", "p99",
+                "p99.9", "max", "p50", "p99", "p99.9", "max");
+}
+
+void print_row(size_t threads, const RunResult& r) {
+    uint64_t ops = r.get.count() + r.put.count();
+    double hit_rate = r.get.count() ? 100.0 * static_cast<double>(r.hits) / static_cast<double>(r.get.count()) : 0;
+    std::printf("%7zu %9.2f %6.1f | %5llu %6llu %6llu %7llu | %5llu %6llu %6llu %7llu\n", threads,
+                static_cast<double>(ops) / r.seconds / 1e6, hit_rate,
+                static_cast<unsigned long long>(r.get.percentile(0.5)),
+                static_cast<unsigned long long>(r.get.percentile(0.99)),
+                static_cast<unsigned long long>(r.get.percentile(0.999)),
+                static_cast<unsigned long long>(r.get.max()),
+                static_cast<unsigned long long>(r.put.percentile(0.5)),
+                static_cast<unsigned long long>(r.put.percentile(0.99)),
+                static_cast<unsigned long long>(r.put.percentile(0.999)),
+                static_cast<unsigned long long>(r.put.max()));
+}
+
+template <typename Cache>
+void sweep(const char* name, const Options& options, const KeyDistribution& keys) {
+    if (options.cache != "all" && options.cache != name) return;
+    print_header(name, options);
+    for (size_t threads : options.threads) {
+        print_row(threads, run<Cache>(options, keys, threads));
+    }
+}
+
+std::vector<size_t> parse_list(const std::string& text) {
+    std::vector<size_t> values;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find(',', start);
+        if (end == std::string::npos) end = text.size();
+        values.push_back(std::stoul(text.substr(start, end - start)));
+        start = end + 1;
+    }
+    return values;
+}
+
+Options parse(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string name = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (name == "--threads") options.threads = parse_list(value);
+        else if (name == "--ops") options.ops = std::stoul(value);
+        else if (name == "--reads") options.reads = std::stod(value);
+        else if (name == "--keys") options.keys = std::stoul(value);
+        else if (name == "--capacity") options.capacity = std::stoul(value);
+        else if (name == "--dist") options.zipf = value != "uniform";
+        else if (name == "--zipf") options.zipf_s = std::stod(value);
+        else if (name == "--cache") options.cache = value;
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            std::exit(2);
+        }
+    }
+    if (options.threads.empty()) {
+        size_t cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+        for (size_t n = 1; n < cores; n *= 2) {
+            options.threads.push_back(n);
+        }
+        options.threads.push_back(cores);
+    }
+    if (options.keys == 0 || options.ops == 0) {
+        std::fprintf(stderr, "--keys and --ops must be positive\n");
+        std::exit(2);
+    }
+    return options;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options = parse(argc, argv);
+    KeyDistribution keys(options);
+    sweep<MutexCache>("mutex", options, keys);
+    sweep<ShardedCache>("sharded", options, keys);
+    sweep<ConcurrentCache>("concurrent", options, keys);
+    return 0;
+}
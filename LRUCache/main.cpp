@@ -1,6 +1,7 @@
 ﻿#include "src/hashtable.hpp"
 #include "src/intrusive_list.hpp"
 #include "src/lru.hpp"
+#include "src/lru_debug.hpp"
 #include <iostream>
 
 void testHashtable();
@@ -100,13 +101,13 @@ void testLRUCache() {
     cache.put(1, "One");
     cache.put(2, "Two");
     cache.put(3, "Three");
-    cache.display();
+    display(cache);
 
     cache.get(2); // Access key 2
-    cache.display();
+    display(cache);
 
     cache.put(4, "Four"); // Evicts key 1 (Least Recently Used)
-    cache.display();
+    display(cache);
 
     try {
         std::cout << cache.get(1) << "\n"; // Key 1 was evicted
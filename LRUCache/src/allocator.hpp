@@ -0,0 +1,157 @@
+// allocator.hpp
+
+#pragma once
+
+#ifndef ALLOCATOR_HPP
+#define ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define ALLOCATOR_HAS_MMAP 1
+#else
+#define ALLOCATOR_HAS_MMAP 0
+#endif
+
+// Allocation policies for the cache's bulk storage: the hash table index and
+// the pages of entries. A policy is a copyable object with
+//
+//   void* allocate(size_t bytes, size_t alignment);
+//   void deallocate(void* p, size_t bytes, size_t alignment);
+//   static constexpr size_t block_size; // preferred allocation size, 0 if none
+//
+// Containers size their pages to block_size when it is set, so that every
+// page fills whole blocks.
+
+// Plain operator new
+struct DefaultAllocator {
+    static constexpr size_t block_size = 0;
+
+    void* allocate(size_t bytes, size_t alignment) {
+        return ::operator new(bytes, std::align_val_t(alignment));
+    }
+
+    void deallocate(void* p, size_t bytes, size_t alignment) {
+        ::operator delete(p, bytes, std::align_val_t(alignment));
+    }
+};
+
+// Maps large blocks directly from the kernel, backed by huge pages where
+// possible, to cut TLB misses on big caches:
+//   - explicit huge pages (MAP_HUGETLB) when the system has a pool reserved,
+//   - otherwise 2 MB-aligned memory advised MADV_HUGEPAGE, which transparent
+//     huge pages can back,
+//   - otherwise ordinary pages.
+// Given a NUMA node, mapped blocks prefer memory on that node (mbind with
+// MPOL_PREFERRED, so allocation still succeeds when the node is full).
+// Blocks under kMinMappedBytes, and every block on platforms without mmap,
+// come from operator new.
+class HugePageAllocator {
+public:
+    static constexpr size_t kHugePageSize = size_t(2) << 20;
+    static constexpr size_t kMinMappedBytes = size_t(64) << 10;
+    static constexpr size_t block_size = kHugePageSize;
+
+    explicit HugePageAllocator(int numa_node = -1) : numa_node_(numa_node) {}
+
+    int numa_node() const { return numa_node_; }
+
+    void* allocate(size_t bytes, size_t alignment) {
+#if ALLOCATOR_HAS_MMAP
+        if (bytes >= kMinMappedBytes) {
+            return map(bytes);
+        }
+#endif
+        return DefaultAllocator().allocate(bytes, alignment);
+    }
+
+    void deallocate(void* p, size_t bytes, size_t alignment) {
+#if ALLOCATOR_HAS_MMAP
+        if (bytes >= kMinMappedBytes) {
+            ::munmap(p, mapped_length(bytes));
+            return;
+        }
+#endif
+        DefaultAllocator().deallocate(p, bytes, alignment);
+    }
+
+    // Length of the mapping behind an allocation of `bytes`
+    static size_t mapped_length(size_t bytes) {
+        size_t unit = bytes >= kHugePageSize ? kHugePageSize : size_t(4096);
+        return (bytes + unit - 1) / unit * unit;
+    }
+
+private:
+    int numa_node_;
+
+#if ALLOCATOR_HAS_MMAP
+    void* map(size_t bytes) {
+        size_t length = mapped_length(bytes);
+        void* p = MAP_FAILED;
+        if (length % kHugePageSize == 0) {
+            p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p == MAP_FAILED) {
+                p = map_aligned(length);
+            }
+        }
+        else {
+            p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        }
+        if (p == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        bind(p, length);
+        return p;
+    }
+
+    // Map `length` bytes on a huge page boundary and ask for transparent
+    // huge pages; the slack around the aligned range is unmapped again
+    static void* map_aligned(size_t length) {
+        void* raw = ::mmap(nullptr, length + kHugePageSize, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            return raw;
+        }
+        uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = (start + kHugePageSize - 1) & ~(uintptr_t(kHugePageSize) - 1);
+        if (aligned > start) {
+            ::munmap(raw, aligned - start);
+        }
+        size_t tail = start + length + kHugePageSize - (aligned + length);
+        if (tail > 0) {
+            ::munmap(reinterpret_cast<void*>(aligned + length), tail);
+        }
+#ifdef MADV_HUGEPAGE
+        ::madvise(reinterpret_cast<void*>(aligned), length, MADV_HUGEPAGE); // Advisory only
+#endif
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    // Prefer the configured node for the mapping's pages. Called before the
+    // pages are touched; failure (no NUMA support, bad node) is ignored.
+    void bind(void* p, size_t length) const {
+#ifdef SYS_mbind
+        constexpr size_t kMaskWords = 16;
+        constexpr int kMpolPreferred = 1;
+        constexpr size_t kWordBits = sizeof(unsigned long) * 8;
+        if (numa_node_ < 0 || static_cast<size_t>(numa_node_) >= kMaskWords * kWordBits) {
+            return;
+        }
+        unsigned long mask[kMaskWords] = {};
+        mask[numa_node_ / kWordBits] = 1UL << (numa_node_ % kWordBits);
+        ::syscall(SYS_mbind, p, length, kMpolPreferred, mask, kMaskWords * kWordBits, 0);
+#else
+        (void)p;
+        (void)length;
+#endif
+    }
+#endif
+};
+
+#endif // ALLOCATOR_HPP
@@ -0,0 +1,190 @@
+// codec.hpp
+
+#pragma once
+
+#ifndef CODEC_HPP
+#define CODEC_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Value codecs for CompressedLRUCache. A codec is a copyable object with
+//
+//   bool compress(std::string_view input, std::string& output);
+//   void decompress(std::string_view input, char* output, size_t size);
+//
+// compress() replaces `output` with an encoding of `input` and returns false
+// if that did not come out smaller, in which case the caller stores `input`
+// as is. decompress() reverses it into exactly `size` bytes, the length of
+// the original input, and throws std::runtime_error on malformed input.
+// A wrapper around LZ4 or zstd fits the same shape.
+
+// Stores everything verbatim
+struct IdentityCodec {
+    bool compress(std::string_view, std::string&) { return false; }
+
+    void decompress(std::string_view input, char* output, size_t size) {
+        if (input.size() != size) {
+            throw std::runtime_error("Corrupt compressed value");
+        }
+        std::memcpy(output, input.data(), size);
+    }
+};
+
+// Byte-oriented LZ77 in the style of the LZ4 block format: fast to decode,
+// no entropy stage, and good at the repeated field names and punctuation
+// of JSON or text protocol buffers. The stream is a series of sequences
+//
+//   token          high nibble: literal count, low nibble: match length - 4,
+//                  15 in either meaning "more length bytes follow"
+//   [length bytes] 255 each until one below 255, added to the literal count
+//   literals
+//   offset         2 bytes, little endian, distance back to the match
+//   [length bytes] likewise for the match length
+//
+// and the last sequence ends after its literals. Matches are found through a
+// hash of the next 4 bytes; stretches that do not match are skipped over
+// faster the longer they run, so incompressible input costs little.
+class LZCodec {
+public:
+    static constexpr size_t kMinMatch = 4;
+    static constexpr size_t kMaxOffset = 65535;
+    static constexpr int kHashBits = 12;
+
+    LZCodec() : table_(size_t(1) << kHashBits) {}
+
+    bool compress(std::string_view input, std::string& output);
+    void decompress(std::string_view input, char* output, size_t size);
+
+private:
+    std::vector<uint32_t> table_; // Hash of 4 bytes -> last position + 1
+
+    static uint32_t read32(const char* p) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static uint32_t hash(uint32_t v) {
+        return (v * 2654435761u) >> (32 - kHashBits);
+    }
+
+    static void put_length(std::string& out, size_t length) {
+        for (; length >= 255; length -= 255) {
+            out.push_back(static_cast<char>(255));
+        }
+        out.push_back(static_cast<char>(length));
+    }
+
+    static void put_sequence(std::string& out, std::string_view literals, size_t offset, size_t match);
+};
+
+// Compress method
+inline bool LZCodec::compress(std::string_view input, std::string& output) {
+    output.clear();
+    output.reserve(input.size());
+    std::fill(table_.begin(), table_.end(), 0);
+
+    const char* src = input.data();
+    size_t size = input.size();
+    size_t anchor = 0; // Start of the pending literals
+    size_t pos = 0;
+    while (pos + kMinMatch <= size) {
+        uint32_t word = read32(src + pos);
+        uint32_t& slot = table_[hash(word)];
+        size_t candidate = slot;
+        slot = static_cast<uint32_t>(pos + 1);
+        if (candidate == 0 || pos - (candidate - 1) > kMaxOffset || read32(src + candidate - 1) != word) {
+            pos += 1 + ((pos - anchor) >> 6);
+            continue;
+        }
+        size_t match = candidate - 1;
+        size_t length = kMinMatch;
+        while (pos + length < size && src[match + length] == src[pos + length]) {
+            ++length;
+        }
+        put_sequence(output, input.substr(anchor, pos - anchor), pos - match, length);
+        if (output.size() >= size) {
+            return false; // Already no smaller; stop early
+        }
+        pos += length;
+        anchor = pos;
+    }
+    put_sequence(output, input.substr(anchor), 0, 0);
+    return output.size() < size;
+}
+
+// Put sequence method; a match length of 0 ends the stream
+inline void LZCodec::put_sequence(std::string& out, std::string_view literals, size_t offset, size_t match) {
+    size_t extra = match ? match - kMinMatch : 0;
+    uint8_t token = static_cast<uint8_t>((literals.size() < 15 ? literals.size() : 15) << 4 | (extra < 15 ? extra : 15));
+    out.push_back(static_cast<char>(token));
+    if (literals.size() >= 15) {
+        put_length(out, literals.size() - 15);
+    }
+    out.append(literals);
+    if (match == 0) {
+        return;
+    }
+    out.push_back(static_cast<char>(offset & 0xFF));
+    out.push_back(static_cast<char>(offset >> 8));
+    if (extra >= 15) {
+        put_length(out, extra - 15);
+    }
+}
+
+// Decompress method
+inline void LZCodec::decompress(std::string_view input, char* output, size_t size) {
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(input.data());
+    const uint8_t* in_end = in + input.size();
+    size_t out = 0;
+    auto corrupt = []() { throw std::runtime_error("Corrupt compressed value"); };
+    auto read_length = [&](size_t length) {
+        if (length != 15) return length;
+        uint8_t byte;
+        do {
+            if (in == in_end) corrupt();
+            byte = *in++;
+            length += byte;
+        } while (byte == 255);
+        return length;
+    };
+
+    for (;;) {
+        if (in == in_end) corrupt();
+        uint8_t token = *in++;
+        size_t literals = read_length(token >> 4);
+        if (literals > static_cast<size_t>(in_end - in) || literals > size - out) corrupt();
+        if (literals > 0) {
+            std::memcpy(output + out, in, literals);
+        }
+        in += literals;
+        out += literals;
+        if (in == in_end) {
+            break; // Last sequence
+        }
+        if (in_end - in < 2) corrupt();
+        size_t offset = in[0] | size_t(in[1]) << 8;
+        in += 2;
+        size_t length = read_length(token & 0x0F) + kMinMatch;
+        if (offset == 0 || offset > out || length > size - out) corrupt();
+        const char* from = output + out - offset;
+        if (offset >= length) {
+            std::memcpy(output + out, from, length);
+        }
+        else {
+            for (size_t i = 0; i < length; ++i) {
+                output[out + i] = from[i]; // Overlapping: a repeating pattern
+            }
+        }
+        out += length;
+    }
+    if (out != size) corrupt();
+}
+
+#endif // CODEC_HPP
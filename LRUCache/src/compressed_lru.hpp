@@ -0,0 +1,170 @@
+// compressed_lru.hpp
+
+#pragma once
+
+#ifndef COMPRESSED_LRU_HPP
+#define COMPRESSED_LRU_HPP
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "codec.hpp"
+#include "hashtable.hpp"
+#include "intrusive_list.hpp"
+
+// LRU cache of byte-string values with a capacity in bytes, storing large
+// values compressed.
+//
+// Values of at least `threshold` bytes are passed through `Codec` (see
+// codec.hpp) on put and kept in compressed form if that saves at least an
+// eighth of their size; everything else is kept verbatim, so small or
+// incompressible values never pay for decoding. get() decodes into a fresh
+// string, find() into a caller's buffer that can be reused across calls.
+//
+// An entry weighs the bytes it stores for its value, compressed or not, and
+// the least recently used entries are evicted until the total weight fits
+// the capacity. Keys and per-entry bookkeeping are not counted. A value
+// whose stored form alone is larger than the capacity is not cached, and
+// putting one drops any older value for the key.
+template <typename Key, typename Codec = LZCodec>
+class CompressedLRUCache {
+public:
+    explicit CompressedLRUCache(size_t capacity, size_t threshold = 256, const Codec& codec = Codec())
+        : capacity_(capacity), threshold_(threshold), weight_(0), raw_weight_(0), codec_(codec) {
+    }
+
+    void put(const Key& key, std::string_view value);
+
+    std::string get(const Key& key) {
+        std::string value;
+        if (!find(key, value)) {
+            throw std::runtime_error("Key not found");
+        }
+        return value;
+    }
+
+    // Like get(), but returns false instead of throwing on a miss. The value
+    // is decoded into `value`, whose capacity is reused.
+    bool find(const Key& key, std::string& value);
+
+    bool contains(const Key& key) const {
+        return map_.find_index(key) != Map::npos;
+    }
+
+    bool erase(const Key& key) {
+        uint32_t index = map_.find_index(key);
+        if (index == Map::npos) {
+            return false;
+        }
+        remove_at(index);
+        return true;
+    }
+
+    size_t size() const { return map_.size(); }
+    size_t capacity() const { return capacity_; }
+    // Stored bytes of all values, the quantity bounded by capacity()
+    size_t weight() const { return weight_; }
+    // What weight() would be if nothing were compressed
+    size_t raw_weight() const { return raw_weight_; }
+
+    void clear() {
+        list_.clear();
+        map_.clear();
+        weight_ = 0;
+        raw_weight_ = 0;
+    }
+
+    // Heap bytes held by the cache's storage, counting each value's stored
+    // bytes (string allocation overhead is not visible here)
+    size_t memory_usage() const {
+        return map_.memory_usage() + weight_ + scratch_.capacity();
+    }
+
+private:
+    struct Slot {
+        std::string data; // Compressed iff shorter than raw_size
+        size_t raw_size;
+        IndexLinks links;
+    };
+
+    using Map = HashTable<Key, Slot>;
+
+    IndexList list_;
+    Map map_;
+    size_t capacity_;
+    size_t threshold_;
+    size_t weight_;
+    size_t raw_weight_;
+    Codec codec_;
+    std::string scratch_; // Compression output, reused across puts
+
+    auto links() {
+        return [this](uint32_t index) -> IndexLinks& { return map_.entry_at(index).value.links; };
+    }
+
+    void evict() {
+        remove_at(list_.back());
+    }
+
+    void remove_at(uint32_t index) {
+        Slot& slot = map_.entry_at(index).value;
+        weight_ -= slot.data.size();
+        raw_weight_ -= slot.raw_size;
+        list_.remove(index, links());
+        // The table fills the hole with its last entry; follow it
+        uint32_t moved = map_.erase_at(index);
+        if (moved != Map::npos) {
+            list_.relocate(moved, index, links());
+        }
+    }
+};
+
+// Put method
+template <typename Key, typename Codec>
+void CompressedLRUCache<Key, Codec>::put(const Key& key, std::string_view value) {
+    uint32_t existing = map_.find_index(key);
+    if (existing != Map::npos) {
+        remove_at(existing); // Re-inserted below at the front, at its new weight
+    }
+    std::string_view stored = value;
+    if (value.size() >= threshold_ && codec_.compress(value, scratch_) &&
+        scratch_.size() <= value.size() - value.size() / 8) {
+        stored = scratch_;
+    }
+    if (stored.size() > capacity_) {
+        return;
+    }
+    while (!list_.empty() && (weight_ + stored.size() > capacity_ || list_.size() + 1 >= IndexList::npos)) {
+        evict();
+    }
+    map_.insert(key, Slot{ std::string(stored), value.size(), {} });
+    list_.push_front(static_cast<uint32_t>(map_.size() - 1), links());
+    weight_ += stored.size();
+    raw_weight_ += value.size();
+}
+
+// Find method
+template <typename Key, typename Codec>
+bool CompressedLRUCache<Key, Codec>::find(const Key& key, std::string& value) {
+    uint32_t index = map_.find_index(key);
+    if (index == Map::npos) {
+        return false;
+    }
+    list_.move_to_front(index, links());
+    if (map_.rehashing()) {
+        map_.rehash_step(); // Hits drive a pending rehash too, not just inserts
+    }
+    const Slot& slot = map_.entry_at(index).value;
+    if (slot.data.size() == slot.raw_size) {
+        value.assign(slot.data);
+    }
+    else {
+        value.resize(slot.raw_size);
+        codec_.decompress(slot.data, &value[0], slot.raw_size);
+    }
+    return true;
+}
+
+#endif // COMPRESSED_LRU_HPP
@@ -0,0 +1,396 @@
+// concurrent_hashtable.hpp
+
+#pragma once
+
+#ifndef CONCURRENT_HASHTABLE_HPP
+#define CONCURRENT_HASHTABLE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Hash table whose lookups never block: any number of threads may call
+// find(), contains() and visit() while another thread modifies the table.
+// Writers are serialised by an internal mutex.
+//
+// Slots are atomic pointers to immutable nodes. A writer never changes a
+// published node: an update publishes a replacement and an erase leaves a
+// tombstone, and a resize builds a new slot array and publishes it with a
+// single store. Readers only load and compare, so a lookup finishes in a
+// bounded number of steps however the writer is interleaved.
+//
+// Replaced nodes and old slot arrays are reclaimed by epochs. A reader pins
+// the current epoch in one of kMaxReaders slots for the length of a lookup;
+// a retired object is freed once every pinned reader entered after it was
+// unlinked. A reader that finds every slot taken after one pass does not
+// wait for one: it counts itself as an overflow reader instead, and nothing
+// is freed while any overflow reader is running. Retired objects then pile
+// up only for as long as more than kMaxReaders lookups overlap.
+template <typename Key, typename Value>
+class ConcurrentHashTable {
+public:
+    static constexpr size_t kMaxReaders = 64;
+
+    explicit ConcurrentHashTable(size_t initial_capacity = 16);
+    ~ConcurrentHashTable();
+
+    ConcurrentHashTable(const ConcurrentHashTable&) = delete;
+    ConcurrentHashTable& operator=(const ConcurrentHashTable&) = delete;
+
+    // Writers
+    bool insert(const Key& key, const Value& value); // Insert or update
+    bool erase(const Key& key);
+    void clear();
+
+    // Readers; safe to call concurrently with writers
+    std::optional<Value> find(const Key& key) const;
+    bool contains(const Key& key) const;
+    // Call fn(const Value&) with the value for `key`, without copying it.
+    // Returns false on a miss.
+    template <typename Fn>
+    bool visit(const Key& key, Fn&& fn) const;
+
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+    size_t capacity() const;
+
+    // Free retired objects that no reader can still see; writers do this
+    // as they go. Returns the number still pending.
+    size_t collect();
+
+private:
+    struct Node {
+        Key key;
+        Value value;
+        uint64_t hash;
+    };
+
+    struct Table {
+        explicit Table(size_t capacity) : capacity(capacity), slots(new std::atomic<Node*>[capacity]) {
+            for (size_t i = 0; i < capacity; ++i) {
+                slots[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+        ~Table() { delete[] slots; }
+
+        size_t capacity; // Power of two
+        std::atomic<Node*>* slots;
+    };
+
+    struct Retired {
+        void* object;
+        void (*destroy)(void*);
+        uint64_t epoch;
+    };
+
+    struct alignas(64) ReaderPin {
+        std::atomic<uint64_t> epoch{ 0 }; // 0 when free
+    };
+
+    // Pins an epoch for the duration of a lookup
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const ConcurrentHashTable& table);
+        ~ReadGuard();
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+    private:
+        const ConcurrentHashTable& table_;
+        ReaderPin* pin_; // Null for an overflow reader
+    };
+
+    static constexpr size_t kCollectThreshold = 64; // Retired objects between scans
+
+    std::atomic<Table*> table_;
+    std::atomic<size_t> size_;
+    size_t tombstones_;                // Writer-only
+    std::mutex write_mutex_;
+    std::atomic<uint64_t> epoch_;
+    mutable ReaderPin pins_[kMaxReaders];
+    mutable std::atomic<size_t> overflow_readers_; // Readers that found no free pin
+    std::vector<Retired> retired_;     // Writer-only
+
+    static Node* tombstone() { return reinterpret_cast<Node*>(uintptr_t(1)); }
+    static uint64_t hash(const Key& key);
+    static size_t home(const Table& table, uint64_t h) { return static_cast<size_t>(h >> 7) & (table.capacity - 1); }
+
+    const Node* lookup(const Key& key) const;
+    void place(Table& table, Node* node);
+    void resize(size_t new_capacity);
+    void retire(void* object, void (*destroy)(void*));
+    size_t collect_locked();
+};
+
+template <typename Key, typename Value>
+ConcurrentHashTable<Key, Value>::ReadGuard::ReadGuard(const ConcurrentHashTable& table)
+    : table_(table), pin_(nullptr) {
+    // Start from a per-thread slot so that readers rarely contend
+    static thread_local size_t hint = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    for (size_t i = hint; i < hint + kMaxReaders; ++i) {
+        ReaderPin& pin = table.pins_[i % kMaxReaders];
+        uint64_t expected = 0;
+        if (pin.epoch.load(std::memory_order_relaxed) == 0 &&
+            pin.epoch.compare_exchange_strong(expected, table.epoch_.load(std::memory_order_seq_cst),
+                                              std::memory_order_seq_cst)) {
+            hint = i % kMaxReaders;
+            pin_ = &pin;
+            return;
+        }
+    }
+    table.overflow_readers_.fetch_add(1, std::memory_order_seq_cst);
+}
+
+template <typename Key, typename Value>
+ConcurrentHashTable<Key, Value>::ReadGuard::~ReadGuard() {
+    if (pin_) {
+        pin_->epoch.store(0, std::memory_order_release);
+    }
+    else {
+        table_.overflow_readers_.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+// Constructor
+template <typename Key, typename Value>
+ConcurrentHashTable<Key, Value>::ConcurrentHashTable(size_t initial_capacity)
+    : size_(0), tombstones_(0), epoch_(1), overflow_readers_(0) {
+    size_t capacity = 16;
+    while (capacity < initial_capacity) {
+        capacity *= 2;
+    }
+    table_.store(new Table(capacity), std::memory_order_relaxed);
+}
+
+// Destructor: no reader may be running
+template <typename Key, typename Value>
+ConcurrentHashTable<Key, Value>::~ConcurrentHashTable() {
+    Table* table = table_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < table->capacity; ++i) {
+        Node* node = table->slots[i].load(std::memory_order_relaxed);
+        if (node != nullptr && node != tombstone()) {
+            delete node;
+        }
+    }
+    delete table;
+    for (Retired& r : retired_) {
+        r.destroy(r.object);
+    }
+}
+
+// Insert method
+template <typename Key, typename Value>
+bool ConcurrentHashTable<Key, Value>::insert(const Key& key, const Value& value) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    uint64_t h = hash(key);
+    Table* table = table_.load(std::memory_order_relaxed);
+    size_t mask = table->capacity - 1;
+    for (size_t i = home(*table, h), probes = 0; probes < table->capacity; i = (i + 1) & mask, ++probes) {
+        Node* node = table->slots[i].load(std::memory_order_relaxed);
+        if (node == nullptr) break;
+        if (node != tombstone() && node->hash == h && node->key == key) {
+            // Publish a replacement; readers holding the old node keep it
+            table->slots[i].store(new Node{ key, value, h }, std::memory_order_release);
+            retire(node, [](void* p) { delete static_cast<Node*>(p); });
+            return true;
+        }
+    }
+    size_t used = size_.load(std::memory_order_relaxed);
+    if ((used + tombstones_ + 1) * 4 > table->capacity * 3) {
+        // Grow when live entries need it; otherwise just drop tombstones
+        resize((used + 1) * 2 > table->capacity ? table->capacity * 2 : table->capacity);
+        table = table_.load(std::memory_order_relaxed);
+    }
+    place(*table, new Node{ key, value, h });
+    size_.store(used + 1, std::memory_order_relaxed);
+    return true;
+}
+
+// Erase method
+template <typename Key, typename Value>
+bool ConcurrentHashTable<Key, Value>::erase(const Key& key) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    uint64_t h = hash(key);
+    Table* table = table_.load(std::memory_order_relaxed);
+    size_t mask = table->capacity - 1;
+    for (size_t i = home(*table, h), probes = 0; probes < table->capacity; i = (i + 1) & mask, ++probes) {
+        Node* node = table->slots[i].load(std::memory_order_relaxed);
+        if (node == nullptr) break;
+        if (node != tombstone() && node->hash == h && node->key == key) {
+            table->slots[i].store(tombstone(), std::memory_order_release);
+            ++tombstones_;
+            size_.store(size_.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+            retire(node, [](void* p) { delete static_cast<Node*>(p); });
+            return true;
+        }
+    }
+    return false;
+}
+
+// Clear method
+template <typename Key, typename Value>
+void ConcurrentHashTable<Key, Value>::clear() {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    Table* table = table_.load(std::memory_order_relaxed);
+    // Swap in an empty table; the old one and its nodes go together
+    table_.store(new Table(table->capacity), std::memory_order_release);
+    size_.store(0, std::memory_order_relaxed);
+    tombstones_ = 0;
+    retire(table, [](void* p) {
+        Table* old = static_cast<Table*>(p);
+        for (size_t i = 0; i < old->capacity; ++i) {
+            Node* node = old->slots[i].load(std::memory_order_relaxed);
+            if (node != nullptr && node != tombstone()) {
+                delete node;
+            }
+        }
+        delete old;
+    });
+}
+
+// Find method
+template <typename Key, typename Value>
+std::optional<Value> ConcurrentHashTable<Key, Value>::find(const Key& key) const {
+    ReadGuard guard(*this);
+    const Node* node = lookup(key);
+    if (node == nullptr) {
+        return std::nullopt;
+    }
+    return node->value;
+}
+
+// Contains method
+template <typename Key, typename Value>
+bool ConcurrentHashTable<Key, Value>::contains(const Key& key) const {
+    ReadGuard guard(*this);
+    return lookup(key) != nullptr;
+}
+
+// Visit method
+template <typename Key, typename Value>
+template <typename Fn>
+bool ConcurrentHashTable<Key, Value>::visit(const Key& key, Fn&& fn) const {
+    ReadGuard guard(*this);
+    const Node* node = lookup(key);
+    if (node == nullptr) {
+        return false;
+    }
+    fn(node->value);
+    return true;
+}
+
+// Capacity method
+template <typename Key, typename Value>
+size_t ConcurrentHashTable<Key, Value>::capacity() const {
+    ReadGuard guard(*this);
+    return table_.load(std::memory_order_acquire)->capacity;
+}
+
+// Collect method
+template <typename Key, typename Value>
+size_t ConcurrentHashTable<Key, Value>::collect() {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    return collect_locked();
+}
+
+// Hash function
+template <typename Key, typename Value>
+uint64_t ConcurrentHashTable<Key, Value>::hash(const Key& key) {
+    // Same mixing as HashTable: std::hash is often the identity
+    uint64_t h = static_cast<uint64_t>(std::hash<Key>{}(key)) * 0x9E3779B97F4A7C15ULL;
+    return h ^ (h >> 32);
+}
+
+// Lookup for readers; the caller holds a ReadGuard. At most one pass over
+// the slot array.
+template <typename Key, typename Value>
+auto ConcurrentHashTable<Key, Value>::lookup(const Key& key) const -> const Node* {
+    uint64_t h = hash(key);
+    const Table* table = table_.load(std::memory_order_acquire);
+    size_t mask = table->capacity - 1;
+    for (size_t i = home(*table, h), probes = 0; probes < table->capacity; i = (i + 1) & mask, ++probes) {
+        const Node* node = table->slots[i].load(std::memory_order_acquire);
+        if (node == nullptr) break;
+        if (node != tombstone() && node->hash == h && node->key == key) {
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+// Put a node in the first free slot on its probe path
+template <typename Key, typename Value>
+void ConcurrentHashTable<Key, Value>::place(Table& table, Node* node) {
+    size_t mask = table.capacity - 1;
+    size_t i = home(table, node->hash);
+    for (;;) {
+        Node* current = table.slots[i].load(std::memory_order_relaxed);
+        if (current == nullptr) break;
+        if (current == tombstone()) {
+            --tombstones_;
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+    table.slots[i].store(node, std::memory_order_release);
+}
+
+// Resize: readers keep using the old slot array until they see the new one
+template <typename Key, typename Value>
+void ConcurrentHashTable<Key, Value>::resize(size_t new_capacity) {
+    Table* old = table_.load(std::memory_order_relaxed);
+    Table* table = new Table(new_capacity);
+    size_t mask = new_capacity - 1;
+    for (size_t i = 0; i < old->capacity; ++i) {
+        Node* node = old->slots[i].load(std::memory_order_relaxed);
+        if (node == nullptr || node == tombstone()) continue;
+        size_t j = home(*table, node->hash);
+        while (table->slots[j].load(std::memory_order_relaxed) != nullptr) {
+            j = (j + 1) & mask;
+        }
+        table->slots[j].store(node, std::memory_order_relaxed);
+    }
+    tombstones_ = 0;
+    table_.store(table, std::memory_order_release); // Publishes the filled slots
+    retire(old, [](void* p) { delete static_cast<Table*>(p); });
+}
+
+// Defer destruction of an unlinked object until no reader can hold it
+template <typename Key, typename Value>
+void ConcurrentHashTable<Key, Value>::retire(void* object, void (*destroy)(void*)) {
+    retired_.push_back(Retired{ object, destroy, epoch_.fetch_add(1, std::memory_order_seq_cst) });
+    if (retired_.size() >= kCollectThreshold) {
+        collect_locked();
+    }
+}
+
+// Free retired objects older than every pinned reader
+template <typename Key, typename Value>
+size_t ConcurrentHashTable<Key, Value>::collect_locked() {
+    // An overflow reader's epoch is unknown, so it holds back everything
+    uint64_t oldest = overflow_readers_.load(std::memory_order_seq_cst) == 0 ? UINT64_MAX : 0;
+    for (ReaderPin& pin : pins_) {
+        uint64_t epoch = pin.epoch.load(std::memory_order_seq_cst);
+        if (epoch != 0 && epoch < oldest) {
+            oldest = epoch;
+        }
+    }
+    size_t kept = 0;
+    for (Retired& r : retired_) {
+        if (r.epoch < oldest) {
+            r.destroy(r.object);
+        }
+        else {
+            retired_[kept++] = r;
+        }
+    }
+    retired_.resize(kept);
+    return kept;
+}
+
+#endif // CONCURRENT_HASHTABLE_HPP
@@ -0,0 +1,252 @@
+// disk_tier.hpp
+
+#pragma once
+
+#ifndef DISK_TIER_HPP
+#define DISK_TIER_HPP
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "hashtable.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define DISK_TIER_HAS_PREAD 1
+#else
+#include <fstream>
+#define DISK_TIER_HAS_PREAD 0
+#endif
+
+// File read and written at explicit offsets: pread/pwrite where available,
+// a seeking fstream elsewhere
+class TierFile {
+public:
+    explicit TierFile(const std::string& path) {
+#if DISK_TIER_HAS_PREAD
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (fd_ < 0) {
+            throw std::runtime_error("Cannot open disk tier: " + path);
+        }
+#else
+        file_.open(path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+        if (!file_) {
+            throw std::runtime_error("Cannot open disk tier: " + path);
+        }
+#endif
+    }
+
+    ~TierFile() {
+#if DISK_TIER_HAS_PREAD
+        ::close(fd_);
+#endif
+    }
+
+    TierFile(const TierFile&) = delete;
+    TierFile& operator=(const TierFile&) = delete;
+
+    void write_at(const char* data, size_t size, uint64_t offset) {
+#if DISK_TIER_HAS_PREAD
+        while (size > 0) {
+            ssize_t n = ::pwrite(fd_, data, size, static_cast<off_t>(offset));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                throw std::runtime_error("Disk tier write failed");
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+            offset += static_cast<uint64_t>(n);
+        }
+#else
+        file_.seekp(static_cast<std::streamoff>(offset));
+        if (!file_.write(data, static_cast<std::streamsize>(size))) {
+            throw std::runtime_error("Disk tier write failed");
+        }
+#endif
+    }
+
+    void read_at(char* data, size_t size, uint64_t offset) {
+#if DISK_TIER_HAS_PREAD
+        while (size > 0) {
+            ssize_t n = ::pread(fd_, data, size, static_cast<off_t>(offset));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                throw std::runtime_error("Disk tier read failed");
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+            offset += static_cast<uint64_t>(n);
+        }
+#else
+        file_.seekg(static_cast<std::streamoff>(offset));
+        if (!file_.read(data, static_cast<std::streamsize>(size))) {
+            throw std::runtime_error("Disk tier read failed");
+        }
+#endif
+    }
+
+private:
+#if DISK_TIER_HAS_PREAD
+    int fd_;
+#else
+    std::fstream file_;
+#endif
+};
+
+// Log-structured store of byte strings on a local file, meant as the second
+// tier behind an in-memory cache (see HybridCache).
+//
+// The file is a ring of `segment_count` segments of `segment_size` bytes.
+// Values are appended to the active segment, which is buffered in memory and
+// written with a single large write when it fills; the next segment in the
+// ring then becomes active and everything still stored in it is dropped, so
+// space is reclaimed a whole segment at a time in FIFO order. Values that
+// are overwritten or erased just leave dead bytes behind until their segment
+// comes round again.
+//
+// Only the index lives in memory: 12 bytes of location per key plus the
+// table's overhead. Reclaiming a segment sweeps the index once, which costs
+// about `segment_count` entry visits per stored value.
+//
+// The file is scratch space: it is truncated when the tier is created, and
+// removed when it is destroyed.
+template <typename Key>
+class DiskTier {
+public:
+    DiskTier(const std::string& path, size_t segment_size = size_t(1) << 20, size_t segment_count = 64)
+        : file_(path), path_(path), segment_size_(segment_size), segment_count_(segment_count),
+          active_(0), used_(0), flushed_(0) {
+        if (segment_size_ == 0 || segment_size_ > UINT32_MAX) {
+            throw std::invalid_argument("DiskTier segment size out of range");
+        }
+        if (segment_count_ == 0 || segment_count_ > UINT32_MAX) {
+            throw std::invalid_argument("DiskTier needs at least one segment");
+        }
+        buffer_.resize(segment_size_);
+    }
+
+    ~DiskTier() {
+        std::remove(path_.c_str());
+    }
+
+    DiskTier(const DiskTier&) = delete;
+    DiskTier& operator=(const DiskTier&) = delete;
+
+    // Store `bytes` under `key`, replacing any older copy. Returns false,
+    // storing nothing, if the value is larger than a segment.
+    bool put(const Key& key, std::string_view bytes);
+
+    // Read the value for `key` into `bytes`; false if not stored
+    bool get(const Key& key, std::string& bytes);
+
+    bool contains(const Key& key) const {
+        return index_.find_index(key) != Index::npos;
+    }
+
+    bool erase(const Key& key) {
+        return index_.erase(key);
+    }
+
+    // Write out the buffered part of the active segment
+    void flush();
+
+    size_t size() const { return index_.size(); }
+    size_t capacity_bytes() const { return segment_size_ * segment_count_; }
+
+    // Heap bytes held in memory: the index and the segment buffer
+    size_t memory_usage() const {
+        return index_.memory_usage() + buffer_.capacity();
+    }
+
+private:
+    struct Location {
+        uint32_t segment;
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    using Index = HashTable<Key, Location>;
+
+    TierFile file_;
+    std::string path_;
+    Index index_;
+    std::vector<char> buffer_; // Contents of the active segment
+    size_t segment_size_;
+    size_t segment_count_;
+    uint32_t active_;
+    size_t used_;    // Bytes appended to the active segment
+    size_t flushed_; // Bytes of it already written to the file
+
+    uint64_t file_offset(uint32_t segment, size_t offset) const {
+        return static_cast<uint64_t>(segment) * segment_size_ + offset;
+    }
+
+    void seal();
+};
+
+// Put method
+template <typename Key>
+bool DiskTier<Key>::put(const Key& key, std::string_view bytes) {
+    index_.erase(key);
+    if (bytes.size() > segment_size_) {
+        return false;
+    }
+    if (used_ + bytes.size() > segment_size_) {
+        seal();
+    }
+    if (!bytes.empty()) {
+        std::memcpy(buffer_.data() + used_, bytes.data(), bytes.size());
+    }
+    index_.insert(key, Location{ active_, static_cast<uint32_t>(used_), static_cast<uint32_t>(bytes.size()) });
+    used_ += bytes.size();
+    return true;
+}
+
+// Get method
+template <typename Key>
+bool DiskTier<Key>::get(const Key& key, std::string& bytes) {
+    const Location* location = index_.find(key);
+    if (!location) {
+        return false;
+    }
+    bytes.resize(location->length);
+    if (location->length == 0) {
+        return true;
+    }
+    if (location->segment == active_) {
+        std::memcpy(&bytes[0], buffer_.data() + location->offset, location->length);
+    }
+    else {
+        file_.read_at(&bytes[0], location->length, file_offset(location->segment, location->offset));
+    }
+    return true;
+}
+
+// Flush method
+template <typename Key>
+void DiskTier<Key>::flush() {
+    if (used_ > flushed_) {
+        file_.write_at(buffer_.data() + flushed_, used_ - flushed_, file_offset(active_, flushed_));
+        flushed_ = used_;
+    }
+}
+
+// Seal method: write out the active segment and reuse the oldest one
+template <typename Key>
+void DiskTier<Key>::seal() {
+    flush();
+    active_ = static_cast<uint32_t>((active_ + 1) % segment_count_);
+    uint32_t reclaimed = active_;
+    index_.erase_if([reclaimed](const auto& entry, uint32_t) { return entry.value.segment == reclaimed; });
+    used_ = 0;
+    flushed_ = 0;
+}
+
+#endif // DISK_TIER_HPP
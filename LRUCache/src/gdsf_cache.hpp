@@ -0,0 +1,219 @@
+// gdsf_cache.hpp
+
+#pragma once
+
+#ifndef GDSF_CACHE_HPP
+#define GDSF_CACHE_HPP
+
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "hashtable.hpp"
+
+// Cost-aware cache with GreedyDual-Size-Frequency eviction.
+//
+// Every entry carries the cost of recomputing it and its size. Its priority
+// is L + frequency * cost / size, and the entry with the lowest priority is
+// evicted first. L, the "inflation" value, is raised to the priority of each
+// evicted entry, so entries that stop being hit age out even if they were
+// once expensive or popular.
+//
+// The capacity bounds the total size of the entries; with the default size
+// of 1 it is a count. Priorities live in an indexed binary heap over the
+// table's entry positions, so put, get and eviction are O(log n).
+template <typename Key, typename Value>
+class GDSFCache {
+public:
+    explicit GDSFCache(size_t capacity) : capacity_(capacity), weight_(0), inflation_(0) {}
+
+    // Insert or update `key`. `cost` is what a miss on it would cost to
+    // recompute (any unit, as long as it is consistent), `size` its share
+    // of the capacity. Entries larger than the capacity are not cached.
+    void put(const Key& key, const Value& value, double cost = 1.0, size_t size = 1) {
+        if (size == 0) {
+            throw std::invalid_argument("GDSFCache entry size must be positive");
+        }
+        uint32_t index = map_.find_index(key);
+        if (index != Map::npos) {
+            Slot& slot = map_.entry_at(index).value;
+            weight_ -= slot.size;
+            slot.value = value;
+            slot.cost = cost;
+            slot.size = size;
+            weight_ += size;
+            hit(index);
+            // The entry may now be heavier; make room without evicting it.
+            // Evictions move entries in the table, so look it up each time.
+            while (weight_ > capacity_ && heap_.size() > 1) {
+                evict(map_.find_index(key));
+            }
+            if (weight_ > capacity_) {
+                erase_at(map_.find_index(key));
+            }
+            return;
+        }
+        if (size > capacity_) {
+            return;
+        }
+        while (weight_ + size > capacity_) {
+            evict(Map::npos);
+        }
+        map_.insert(key, Slot{ value, cost, size, 1, 0, 0 });
+        index = static_cast<uint32_t>(map_.size() - 1);
+        Slot& slot = map_.entry_at(index).value;
+        slot.priority = priority_of(slot);
+        slot.heap_pos = static_cast<uint32_t>(heap_.size());
+        heap_.push_back(index);
+        sift_up(slot.heap_pos);
+        weight_ += size;
+    }
+
+    Value get(const Key& key) {
+        uint32_t index = map_.find_index(key);
+        if (index == Map::npos) {
+            throw std::runtime_error("Key not found");
+        }
+        hit(index);
+        return map_.entry_at(index).value.value;
+    }
+
+    // Like get(), but returns nullptr instead of throwing on a miss. The
+    // pointer is valid until the next call that modifies the cache.
+    Value* find(const Key& key) {
+        uint32_t index = map_.find_index(key);
+        if (index == Map::npos) {
+            return nullptr;
+        }
+        hit(index);
+        return &map_.entry_at(index).value.value;
+    }
+
+    bool contains(const Key& key) const {
+        return map_.find_index(key) != Map::npos;
+    }
+
+    size_t size() const { return map_.size(); }
+    size_t weight() const { return weight_; }
+    size_t capacity() const { return capacity_; }
+
+    // Current inflation value L; a new entry's priority is L + cost / size
+    double inflation() const { return inflation_; }
+
+    void clear() {
+        map_.clear();
+        heap_.clear();
+        weight_ = 0;
+        inflation_ = 0;
+    }
+
+private:
+    struct Slot {
+        Value value;
+        double cost;
+        size_t size;
+        uint32_t frequency;
+        uint32_t heap_pos;  // Position in heap_
+        double priority;
+    };
+
+    using Map = HashTable<Key, Slot>;
+
+    Map map_;
+    std::vector<uint32_t> heap_; // Min-heap of table positions by priority
+    size_t capacity_;
+    size_t weight_;
+    double inflation_;
+
+    double priority_of(const Slot& slot) const {
+        return inflation_ + static_cast<double>(slot.frequency) * slot.cost / static_cast<double>(slot.size);
+    }
+
+    double priority_at(size_t pos) const {
+        return map_.entry_at(heap_[pos]).value.priority;
+    }
+
+    void hit(uint32_t index) {
+        Slot& slot = map_.entry_at(index).value;
+        ++slot.frequency;
+        slot.priority = priority_of(slot);
+        // A cheaper update can lower the priority, so restore either way
+        sift_down(sift_up(slot.heap_pos));
+    }
+
+    // Evict the lowest-priority entry other than `keep`
+    void evict(uint32_t keep) {
+        uint32_t victim = heap_[0];
+        if (victim == keep) {
+            // Take the smaller child of the root instead
+            victim = heap_.size() > 2 && priority_at(2) < priority_at(1) ? heap_[2] : heap_[1];
+        }
+        // L is the lowest priority of the evicted entry and those that stay:
+        // a kept root may rank below the victim
+        inflation_ = map_.entry_at(victim).value.priority;
+        erase_at(victim);
+        if (!heap_.empty() && priority_at(0) < inflation_) {
+            inflation_ = priority_at(0);
+        }
+    }
+
+    void erase_at(uint32_t index) {
+        Slot& slot = map_.entry_at(index).value;
+        weight_ -= slot.size;
+        remove_from_heap(slot.heap_pos);
+        // The table fills the hole with its last entry; follow it
+        uint32_t moved = map_.erase_at(index);
+        if (moved != Map::npos) {
+            heap_[map_.entry_at(index).value.heap_pos] = index;
+        }
+    }
+
+    void remove_from_heap(size_t pos) {
+        size_t last = heap_.size() - 1;
+        if (pos != last) {
+            place(pos, heap_[last]);
+            heap_.pop_back();
+            sift_down(sift_up(pos));
+        }
+        else {
+            heap_.pop_back();
+        }
+    }
+
+    void place(size_t pos, uint32_t index) {
+        heap_[pos] = index;
+        map_.entry_at(index).value.heap_pos = static_cast<uint32_t>(pos);
+    }
+
+    // Returns the entry's final position
+    size_t sift_up(size_t pos) {
+        uint32_t index = heap_[pos];
+        double priority = map_.entry_at(index).value.priority;
+        while (pos > 0) {
+            size_t parent = (pos - 1) / 2;
+            if (priority_at(parent) <= priority) break;
+            place(pos, heap_[parent]);
+            pos = parent;
+        }
+        place(pos, index);
+        return pos;
+    }
+
+    void sift_down(size_t pos) {
+        uint32_t index = heap_[pos];
+        double priority = map_.entry_at(index).value.priority;
+        for (;;) {
+            size_t child = 2 * pos + 1;
+            if (child >= heap_.size()) break;
+            if (child + 1 < heap_.size() && priority_at(child + 1) < priority_at(child)) {
+                ++child;
+            }
+            if (priority <= priority_at(child)) break;
+            place(pos, heap_[child]);
+            pos = child;
+        }
+        place(pos, index);
+    }
+};
+
+#endif // GDSF_CACHE_HPP
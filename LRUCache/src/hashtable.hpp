@@ -5,55 +5,123 @@
 #ifndef HASHTABLE_HPP
 #define HASHTABLE_HPP
 
-#include <vector>  // for std::vector
-#include <iostream> // for debugging
+#include <cstddef>    // for std::ptrdiff_t
+#include <cstdint>    // for fixed-width integers
+#include <cstring>    // for std::memset
+#include <functional> // for std::hash
+#include <iterator>   // for std::forward_iterator_tag
+#include <stdexcept>  // for std::length_error
+#include <thread>     // for std::thread
+#include <type_traits> // for std::conditional_t
+#include <utility>    // for std::move
+#include <vector>     // for std::vector
+#include "allocator.hpp"
+#include "paged_vector.hpp"
+#include "trace.hpp"
 
-template <typename Key, typename Value>
+// Open-addressing hash table with a compact layout.
+//
+// Entries live contiguously in insertion order, with no per-entry allocation
+// and no holes: erasing moves the last entry into the freed position. The
+// table proper is a separate index of 5 bytes per slot, a control byte and
+// the 32-bit position of the entry. The control byte folds the slot state
+// (empty / erased) into a 7-bit fingerprint of the hash, so probing reads
+// only control bytes and the full key is compared only on a fingerprint
+// match.
+//
+// Resizing never stops the world. Entries sit in fixed-size pages that are
+// never copied once full, and a rehash builds the new index alongside the old
+// one: every insert and erase migrates a bounded number of old slots, and
+// lookups consult both indexes until the old one has drained (the scheme
+// Redis's dict uses for its buckets).
+//
+// Index arrays and entry pages come from `Alloc` (see allocator.hpp).
+// `Trace` receives rehash, index allocation and long-probe events (see
+// trace.hpp); the default NoTrace compiles them out.
+template <typename Key, typename Value, typename Alloc = DefaultAllocator, typename Trace = NoTrace>
 class HashTable {
 public:
     // Define Entry type inside the class template
     struct Entry {
         Key key;
         Value value;
-        bool is_active;
     };
 
-    // Iterator class
-    class Iterator {
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    // Old index slots migrated per modifying operation during a rehash
+    static constexpr size_t kRehashStep = 16;
+
+    // Forward iterators over the entries in storage order. Any insert or
+    // erase invalidates them.
+    template <bool Const>
+    class BasicIterator {
+        using Storage = std::conditional_t<Const, const PagedVector<Entry, Alloc>, PagedVector<Entry, Alloc>>;
+
     public:
-        Iterator(std::vector<Entry*>& table, size_t index)
-            : table_(table), index_(index) {
-            moveToNextActive();  // Move to the first active element
+        using iterator_concept = std::forward_iterator_tag;
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Entry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const Entry*, Entry*>;
+        using reference = std::conditional_t<Const, const Entry&, Entry&>;
+
+        BasicIterator() : entries_(nullptr), index_(0) {}
+
+        BasicIterator(Storage& entries, size_t index)
+            : entries_(&entries), index_(index) {
         }
 
-        bool operator!=(const Iterator& other) const {
-            return index_ != other.index_;
+        // Iterator converts to ConstIterator
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        BasicIterator(const BasicIterator<false>& other)
+            : entries_(other.entries_), index_(other.index_) {
         }
 
-        typename HashTable<Key, Value>::Entry& operator*() {
-            return *table_[index_];
+        reference operator*() const {
+            return (*entries_)[index_];
         }
 
-        Iterator& operator++() {
+        pointer operator->() const {
+            return &(*entries_)[index_];
+        }
+
+        BasicIterator& operator++() {
             ++index_;
-            moveToNextActive();
             return *this;
         }
 
-    private:
-        void moveToNextActive() {
-            // Move to the next active entry in the table
-            while (index_ < table_.size() && (!table_[index_] || !table_[index_]->is_active)) {
-                ++index_;
-            }
+        BasicIterator operator++(int) {
+            BasicIterator previous = *this;
+            ++index_;
+            return previous;
         }
 
-        std::vector<Entry*>& table_;
+        friend bool operator==(const BasicIterator& a, const BasicIterator& b) {
+            return a.index_ == b.index_;
+        }
+
+        friend bool operator!=(const BasicIterator& a, const BasicIterator& b) {
+            return a.index_ != b.index_;
+        }
+
+    private:
+        template <bool>
+        friend class BasicIterator;
+
+        Storage* entries_;
         size_t index_;
     };
 
+    using Iterator = BasicIterator<false>;
+    using ConstIterator = BasicIterator<true>;
+
     // Constructor
-    HashTable(size_t initial_capacity = 16);
+    HashTable(size_t initial_capacity = 16, const Alloc& alloc = Alloc());
+    ~HashTable();
+
+    HashTable(const HashTable&) = delete;
+    HashTable& operator=(const HashTable&) = delete;
 
     bool insert(const Key& key, const Value& value);
     bool erase(const Key& key);
@@ -61,118 +129,598 @@ public:
 
     size_t size() const;
     void clear();
+    void reserve(size_t count); // Size the table so `count` inserts never rehash
+    // Return storage and index memory beyond what size() entries need,
+    // rebuilding a smaller index in one go
+    void shrink_to_fit();
+
+    // Position-based access. Entries occupy positions [0, size()); a newly
+    // inserted key is appended at position size() - 1.
+    uint32_t find_index(const Key& key) const;
+    // Start loading the index lines `key` hashes to, so that a caller with
+    // a batch of keys can overlap their cache misses before looking them up
+    void prefetch(const Key& key) const;
+    Entry& entry_at(uint32_t index) { return entries_[index]; }
+    const Entry& entry_at(uint32_t index) const { return entries_[index]; }
+    // Erase the entry at `index` by moving the last entry into its place.
+    // Returns the moved entry's old position, or npos if nothing moved.
+    uint32_t erase_at(uint32_t index);
+    // Erase every entry for which pred(entry, position) is true in a single
+    // pass over storage, sliding the survivors down in order. moved(from, to)
+    // is called after each survivor changes position. Returns the number of
+    // entries erased.
+    template <typename Pred, typename Moved>
+    size_t erase_if(Pred&& pred, Moved&& moved);
+    template <typename Pred>
+    size_t erase_if(Pred&& pred) {
+        return erase_if(pred, [](uint32_t, uint32_t) {});
+    }
+    // Insert key_at(i) -> value_at(i) for i in [0, count) into an empty
+    // table, sizing it once. Hashing and index placement are split across
+    // up to `threads` threads, each owning a contiguous range of index
+    // slots; entries keep input order. Of repeated keys the first is kept.
+    // Uses about 13 bytes per entry of scratch space. On a table that is
+    // not empty this is a loop over insert() that skips keys already
+    // present. Returns the number of entries inserted.
+    template <typename KeyAt, typename ValueAt>
+    size_t insert_bulk(size_t count, KeyAt&& key_at, ValueAt&& value_at, size_t threads = 1);
+
+    // Incremental rehashing is on by default; when off, a rehash rebuilds
+    // the whole index inside the insert that triggers it
+    void set_incremental_rehash(bool enabled);
+    bool rehashing() const { return old_.capacity != 0; }
+    // Migrate up to `slots` old index slots; lets an idle caller finish a
+    // rehash that modifying operations would otherwise drive
+    void rehash_step(size_t slots = kRehashStep);
+
+    size_t capacity() const { return index_.capacity; }     // Index slots
+    size_t entry_capacity() const { return entries_.capacity(); }
+    size_t memory_usage() const;                            // Heap bytes held
 
     // Provide begin and end methods for iteration
     Iterator begin() {
-        return Iterator(table_, 0);
+        return Iterator(entries_, 0);
     }
 
     Iterator end() {
-        return Iterator(table_, table_.size());
+        return Iterator(entries_, entries_.size());
+    }
+
+    ConstIterator begin() const {
+        return ConstIterator(entries_, 0);
+    }
+
+    ConstIterator end() const {
+        return ConstIterator(entries_, entries_.size());
     }
 
 private:
-    std::vector<Entry*> table_; // A vector of pointers to Entry objects
-    size_t num_elements_;
-    size_t capacity_;
+    // Control byte values; full slots hold a fingerprint in 0x00..0x7F
+    static constexpr uint8_t kEmpty = 0x80;
+    static constexpr uint8_t kErased = 0xFE;
+    static constexpr size_t kNoSlot = SIZE_MAX;
+    static constexpr size_t kLongProbe = 16; // Probe length reported to Trace
+    static constexpr size_t kMinBulkSlots = 4096; // Smallest index range per insert_bulk() thread
+
+    // Both arrays share one allocation: `capacity` control bytes followed
+    // by `capacity` slots
+    struct Index {
+        uint8_t* ctrl = nullptr;     // Per slot: kEmpty, kErased or fingerprint
+        uint32_t* slots = nullptr;   // Per slot: position in entries_, left
+                                     // uninitialised until claimed
+        size_t capacity = 0;         // Power of two; 0 when unused
+        size_t erased = 0;
+
+        static size_t bytes(size_t capacity) { return capacity * (sizeof(uint8_t) + sizeof(uint32_t)); }
+        size_t home(uint64_t h) const { return static_cast<size_t>(h >> 7) & (capacity - 1); }
+        bool over_loaded(size_t used_slots) const { return used_slots * 4 > capacity * 3; }
+    };
+
+    Alloc alloc_;
+    PagedVector<Entry, Alloc> entries_; // Dense storage in insertion order
+    Index index_;                // Receives every insert
+    Index old_;                  // Being drained into index_ during a rehash
+    size_t migrate_pos_;         // Next old_ slot to migrate
+    bool incremental_;
+
+    uint64_t hash(const Key& key) const;
+    static uint8_t fingerprint(uint64_t h) { return static_cast<uint8_t>(h & 0x7F); }
+
+    size_t lookup(const Index& index, uint64_t h, const Key& key) const;
+    size_t slot_of(const Index& index, const Key& key, uint32_t position) const;
+    void place(Index& index, uint64_t h, uint32_t position);
+    void forget(Index& index, const Key& key, uint32_t position);
+    void repoint(Index& index, const Key& key, uint32_t from, uint32_t to);
+    void allocate_index(Index& index, size_t capacity);
+    void release_index(Index& index);
+    void rehash(size_t new_capacity);
+    void rebuild_index(size_t capacity);
+    void finish_rehash();
+
+    // Run fn(0) .. fn(threads - 1) on as many threads, one on the caller's
+    template <typename Fn>
+    static void run_parallel(size_t threads, Fn&& fn);
+
+    static void trace_probe(size_t probes) {
+        if constexpr (Trace::enabled) {
+            if (probes >= kLongProbe) {
+                Trace::instant(TraceEvent::LongProbe, probes);
+            }
+        }
+    }
 
-    size_t hash(const Key& key) const;
-    void rehash();
+    uint64_t trace_id() const { return reinterpret_cast<uintptr_t>(this); }
 };
 
 // Constructor
-template <typename Key, typename Value>
-HashTable<Key, Value>::HashTable(size_t initial_capacity)
-    : table_(initial_capacity, nullptr), num_elements_(0), capacity_(initial_capacity) {
+template <typename Key, typename Value, typename Alloc, typename Trace>
+HashTable<Key, Value, Alloc, Trace>::HashTable(size_t initial_capacity, const Alloc& alloc)
+    : alloc_(alloc), entries_(alloc), migrate_pos_(0), incremental_(true) {
+    size_t capacity = 16;
+    while (capacity < initial_capacity) {
+        capacity *= 2;
+    }
+    allocate_index(index_, capacity);
+}
+
+// Destructor
+template <typename Key, typename Value, typename Alloc, typename Trace>
+HashTable<Key, Value, Alloc, Trace>::~HashTable() {
+    release_index(index_);
+    release_index(old_);
 }
 
 // Insert method
-template <typename Key, typename Value>
-bool HashTable<Key, Value>::insert(const Key& key, const Value& value) {
-    if (num_elements_ > capacity_ / 2) {
-        rehash();
+template <typename Key, typename Value, typename Alloc, typename Trace>
+bool HashTable<Key, Value, Alloc, Trace>::insert(const Key& key, const Value& value) {
+    uint32_t existing = find_index(key);
+    if (existing != npos) {
+        entries_[existing].value = value;  // Update the value if key already exists
+        return true;
     }
-    size_t idx = hash(key) % capacity_;
-    for (size_t i = 0; i < capacity_; ++i) {
-        Entry*& entry = table_[(idx + i) % capacity_];
-        if (!entry || !entry->is_active || entry->key == key) {
-            if (!entry) entry = new Entry{ key, value, true };
-            else entry->value = value;  // Update the value if key already exists
-            ++num_elements_;
-            return true;
-        }
+    if (entries_.size() >= npos) {
+        throw std::length_error("HashTable is full");
+    }
+    if (rehashing()) {
+        rehash_step();
     }
-    return false;
+    if (index_.over_loaded(entries_.size() + index_.erased + 1)) {
+        // Drop erased slots in place while there is ample headroom, so the
+        // rebuilt index cannot fill up before it has drained; grow otherwise
+        rehash(entries_.size() * 2 < index_.capacity ? index_.capacity : index_.capacity * 2);
+    }
+    entries_.push_back(Entry{ key, value });
+    place(index_, hash(key), static_cast<uint32_t>(entries_.size() - 1));
+    return true;
 }
 
 // Erase method
-template <typename Key, typename Value>
-bool HashTable<Key, Value>::erase(const Key& key) {
-    size_t idx = hash(key) % capacity_;
-    for (size_t i = 0; i < capacity_; ++i) {
-        Entry*& entry = table_[(idx + i) % capacity_];
-        if (entry && entry->is_active && entry->key == key) {
-            entry->is_active = false;
-            --num_elements_;
-            return true;
-        }
+template <typename Key, typename Value, typename Alloc, typename Trace>
+bool HashTable<Key, Value, Alloc, Trace>::erase(const Key& key) {
+    uint32_t index = find_index(key);
+    if (index == npos) {
+        return false;
     }
-    return false;
+    erase_at(index);
+    return true;
 }
 
 // Find method
-template <typename Key, typename Value>
-Value* HashTable<Key, Value>::find(const Key& key) {
-    size_t idx = hash(key) % capacity_;
-    for (size_t i = 0; i < capacity_; ++i) {
-        Entry*& entry = table_[(idx + i) % capacity_];
-        if (entry && entry->is_active && entry->key == key) {
-            return &entry->value;  // Return pointer to the value
+template <typename Key, typename Value, typename Alloc, typename Trace>
+Value* HashTable<Key, Value, Alloc, Trace>::find(const Key& key) {
+    uint32_t index = find_index(key);
+    if (index == npos) {
+        return nullptr;  // Return nullptr if key is not found
+    }
+    return &entries_[index].value;  // Return pointer to the value
+}
+
+// Find index method
+template <typename Key, typename Value, typename Alloc, typename Trace>
+uint32_t HashTable<Key, Value, Alloc, Trace>::find_index(const Key& key) const {
+    uint64_t h = hash(key);
+    size_t slot = lookup(index_, h, key);
+    if (slot != kNoSlot) {
+        return index_.slots[slot];
+    }
+    // Keys not migrated yet are only in the old index
+    if (rehashing() && (slot = lookup(old_, h, key)) != kNoSlot) {
+        return old_.slots[slot];
+    }
+    return npos;
+}
+
+// Erase at index method
+template <typename Key, typename Value, typename Alloc, typename Trace>
+uint32_t HashTable<Key, Value, Alloc, Trace>::erase_at(uint32_t index) {
+    if (rehashing()) {
+        rehash_step();
+    }
+    // During a rehash the entry may be in either index, or both
+    forget(index_, entries_[index].key, index);
+    if (rehashing()) {
+        forget(old_, entries_[index].key, index);
+    }
+
+    uint32_t last = static_cast<uint32_t>(entries_.size() - 1);
+    if (index == last) {
+        entries_.pop_back();
+        return npos;
+    }
+    // Fill the hole with the last entry and repoint its slots
+    repoint(index_, entries_[last].key, last, index);
+    if (rehashing()) {
+        repoint(old_, entries_[last].key, last, index);
+    }
+    entries_[index] = std::move(entries_[last]);
+    entries_.pop_back();
+    return last;
+}
+
+// Erase if method
+template <typename Key, typename Value, typename Alloc, typename Trace>
+template <typename Pred, typename Moved>
+size_t HashTable<Key, Value, Alloc, Trace>::erase_if(Pred&& pred, Moved&& moved) {
+    finish_rehash(); // A full pass anyway; keep to one index
+    size_t count = entries_.size();
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t from = static_cast<uint32_t>(i);
+        if (pred(entries_[i], from)) {
+            forget(index_, entries_[i].key, from);
+            continue;
+        }
+        if (kept != i) {
+            uint32_t to = static_cast<uint32_t>(kept);
+            repoint(index_, entries_[i].key, from, to);
+            entries_[kept] = std::move(entries_[i]);
+            moved(from, to);
+        }
+        ++kept;
+    }
+    while (entries_.size() > kept) {
+        entries_.pop_back();
+    }
+    return count - kept;
+}
+
+// Bulk insert method
+template <typename Key, typename Value, typename Alloc, typename Trace>
+template <typename KeyAt, typename ValueAt>
+size_t HashTable<Key, Value, Alloc, Trace>::insert_bulk(size_t count, KeyAt&& key_at, ValueAt&& value_at, size_t threads) {
+    if (!entries_.empty()) {
+        size_t inserted = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const auto& key = key_at(i);
+            if (find_index(key) == npos) {
+                insert(key, value_at(i));
+                ++inserted;
+            }
+        }
+        return inserted;
+    }
+    if (count >= npos) {
+        throw std::length_error("HashTable is full");
+    }
+    finish_rehash();
+    reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        entries_.push_back(Entry{ key_at(i), value_at(i) });
+    }
+
+    size_t partitions = index_.capacity / kMinBulkSlots;
+    partitions = threads < partitions ? threads : partitions;
+    partitions = partitions > 0 ? partitions : 1;
+    size_t range = (index_.capacity + partitions - 1) / partitions;
+
+    // Hash every key up front in one tight loop per thread, so that the
+    // loop vectorises for simple keys and placement below never waits on it
+    std::vector<uint64_t> hashes(count);
+    run_parallel(partitions, [&](size_t part) {
+        size_t end = (part + 1) * count / partitions;
+        for (size_t i = part * count / partitions; i < end; ++i) {
+            hashes[i] = hash(entries_[i].key);
+        }
+    });
+
+    // Group positions by the range their home slot falls in, in input order
+    std::vector<size_t> starts(partitions + 1, 0);
+    for (size_t i = 0; i < count; ++i) {
+        ++starts[index_.home(hashes[i]) / range + 1];
+    }
+    for (size_t part = 0; part < partitions; ++part) {
+        starts[part + 1] += starts[part];
+    }
+    std::vector<uint32_t> order(count);
+    {
+        std::vector<size_t> next(starts.begin(), starts.end() - 1);
+        for (size_t i = 0; i < count; ++i) {
+            order[next[index_.home(hashes[i]) / range]++] = static_cast<uint32_t>(i);
         }
     }
-    return nullptr;  // Return nullptr if key is not found
+
+    // Each thread places the keys homed in its range without leaving it. A
+    // repeated key has the same home, so its first copy is always met on
+    // the way; keys whose probe would cross into the next range are placed
+    // afterwards on this thread.
+    std::vector<uint8_t> duplicate(count, 0);
+    std::vector<std::vector<uint32_t>> overflow(partitions);
+    run_parallel(partitions, [&](size_t part) {
+        size_t end = (part + 1) * range < index_.capacity ? (part + 1) * range : index_.capacity;
+        for (size_t k = starts[part]; k < starts[part + 1]; ++k) {
+            uint32_t position = order[k];
+            uint8_t tag = fingerprint(hashes[position]);
+            size_t i = index_.home(hashes[position]);
+            for (; i < end; ++i) {
+                if (index_.ctrl[i] == kEmpty) {
+                    index_.ctrl[i] = tag;
+                    index_.slots[i] = position;
+                    break;
+                }
+                if (index_.ctrl[i] == tag && entries_[index_.slots[i]].key == entries_[position].key) {
+                    duplicate[position] = 1;
+                    break;
+                }
+            }
+            if (i == end) {
+                overflow[part].push_back(position);
+            }
+        }
+    });
+    for (const auto& positions : overflow) {
+        for (uint32_t position : positions) {
+            if (lookup(index_, hashes[position], entries_[position].key) != kNoSlot) {
+                duplicate[position] = 1;
+            }
+            else {
+                place(index_, hashes[position], position);
+            }
+        }
+    }
+
+    size_t duplicates = 0;
+    for (uint8_t d : duplicate) {
+        duplicates += d;
+    }
+    if (duplicates > 0) {
+        erase_if([&](const Entry&, uint32_t position) { return duplicate[position] != 0; });
+    }
+    return count - duplicates;
+}
+
+// Prefetch method
+template <typename Key, typename Value, typename Alloc, typename Trace>
+void HashTable<Key, Value, Alloc, Trace>::prefetch(const Key& key) const {
+#if defined(__GNUC__)
+    size_t slot = index_.home(hash(key));
+    __builtin_prefetch(index_.ctrl + slot);
+    __builtin_prefetch(index_.slots + slot);
+#else
+    (void)key;
+#endif
 }
 
 // Size method
-template <typename Key, typename Value>
-size_t HashTable<Key, Value>::size() const {
-    return num_elements_;
+template <typename Key, typename Value, typename Alloc, typename Trace>
+size_t HashTable<Key, Value, Alloc, Trace>::size() const {
+    return entries_.size();
 }
 
 // Clear method
-template <typename Key, typename Value>
-void HashTable<Key, Value>::clear() {
-    for (size_t i = 0; i < capacity_; ++i) {
-        delete table_[i];  // Clean up dynamically allocated memory
+template <typename Key, typename Value, typename Alloc, typename Trace>
+void HashTable<Key, Value, Alloc, Trace>::clear() {
+    entries_.clear();
+    std::memset(index_.ctrl, kEmpty, index_.capacity);
+    index_.erased = 0;
+    release_index(old_);
+}
+
+// Reserve method
+template <typename Key, typename Value, typename Alloc, typename Trace>
+void HashTable<Key, Value, Alloc, Trace>::reserve(size_t count) {
+    size_t new_capacity = index_.capacity;
+    while (count * 4 > new_capacity * 3) {
+        new_capacity *= 2;
+    }
+    if (new_capacity != index_.capacity) {
+        rehash(new_capacity);
+    }
+    entries_.reserve(count);
+}
+
+// Shrink to fit method
+template <typename Key, typename Value, typename Alloc, typename Trace>
+void HashTable<Key, Value, Alloc, Trace>::shrink_to_fit() {
+    finish_rehash();
+    size_t new_capacity = 16;
+    while (entries_.size() * 4 > new_capacity * 3) {
+        new_capacity *= 2;
+    }
+    if (new_capacity < index_.capacity) {
+        TraceScope<Trace> scope(TraceEvent::Rehash, new_capacity);
+        rebuild_index(new_capacity);
+    }
+    entries_.shrink_to_fit();
+}
+
+// Toggle incremental rehashing
+template <typename Key, typename Value, typename Alloc, typename Trace>
+void HashTable<Key, Value, Alloc, Trace>::set_incremental_rehash(bool enabled) {
+    incremental_ = enabled;
+    if (!enabled) {
+        finish_rehash();
     }
-    table_.clear();
-    table_.resize(capacity_, nullptr);
-    num_elements_ = 0;
+}
+
+// Rehash step: move old index slots into the new index
+template <typename Key, typename Value, typename Alloc, typename Trace>
+void HashTable<Key, Value, Alloc, Trace>::rehash_step(size_t slots) {
+    size_t end = migrate_pos_ + slots < old_.capacity ? migrate_pos_ + slots : old_.capacity;
+    for (; migrate_pos_ < end; ++migrate_pos_) {
+        if (old_.ctrl[migrate_pos_] < kEmpty) {
+            uint32_t position = old_.slots[migrate_pos_];
+            place(index_, hash(entries_[position].key), position);
+        }
+    }
+    if (migrate_pos_ == old_.capacity) {
+        release_index(old_);
+        Trace::async_end(TraceEvent::Migrate, trace_id());
+    }
+}
+
+// Memory usage method
+template <typename Key, typename Value, typename Alloc, typename Trace>
+size_t HashTable<Key, Value, Alloc, Trace>::memory_usage() const {
+    return entries_.capacity() * sizeof(Entry) + Index::bytes(index_.capacity) + Index::bytes(old_.capacity);
 }
 
 // Hash function
-template <typename Key, typename Value>
-size_t HashTable<Key, Value>::hash(const Key& key) const {
-    return std::hash<Key>{}(key);
-}
-
-// Rehash function
-template <typename Key, typename Value>
-void HashTable<Key, Value>::rehash() {
-    capacity_ *= 2;
-    std::vector<Entry*> new_table(capacity_, nullptr);
-    for (size_t i = 0; i < capacity_ / 2; ++i) {
-        if (table_[i]) {
-            size_t idx = hash(table_[i]->key) % capacity_;
-            for (size_t j = 0; j < capacity_; ++j) {
-                if (!new_table[(idx + j) % capacity_]) {
-                    new_table[(idx + j) % capacity_] = table_[i];
-                    break;
-                }
-            }
+template <typename Key, typename Value, typename Alloc, typename Trace>
+uint64_t HashTable<Key, Value, Alloc, Trace>::hash(const Key& key) const {
+    // std::hash is often the identity; mix it so that both the slot and
+    // the fingerprint depend on every bit of the key
+    uint64_t h = static_cast<uint64_t>(std::hash<Key>{}(key)) * 0x9E3779B97F4A7C15ULL;
+    return h ^ (h >> 32);
+}
+
+// Find the slot holding `key`, or kNoSlot
+template <typename Key, typename Value, typename Alloc, typename Trace>
+size_t HashTable<Key, Value, Alloc, Trace>::lookup(const Index& index, uint64_t h, const Key& key) const {
+    uint8_t tag = fingerprint(h);
+    size_t mask = index.capacity - 1;
+    size_t probes = 0;
+    for (size_t i = index.home(h); index.ctrl[i] != kEmpty && probes < index.capacity; i = (i + 1) & mask, ++probes) {
+        if (index.ctrl[i] == tag && entries_[index.slots[i]].key == key) {
+            trace_probe(probes);
+            return i;
         }
     }
-    table_ = std::move(new_table);
+    trace_probe(probes);
+    return kNoSlot;
+}
+
+// Locate the slot that points at `position`, which holds `key`, or kNoSlot
+// if this index has no slot for it
+template <typename Key, typename Value, typename Alloc, typename Trace>
+size_t HashTable<Key, Value, Alloc, Trace>::slot_of(const Index& index, const Key& key, uint32_t position) const {
+    uint64_t h = hash(key);
+    uint8_t tag = fingerprint(h);
+    size_t mask = index.capacity - 1;
+    for (size_t i = index.home(h), probes = 0; index.ctrl[i] != kEmpty && probes < index.capacity; i = (i + 1) & mask, ++probes) {
+        if (index.ctrl[i] == tag && index.slots[i] == position) {
+            return i;
+        }
+    }
+    return kNoSlot;
+}
+
+// Claim the first free slot on the probe path of `h`
+template <typename Key, typename Value, typename Alloc, typename Trace>
+void HashTable<Key, Value, Alloc, Trace>::place(Index& index, uint64_t h, uint32_t position) {
+    size_t mask = index.capacity - 1;
+    size_t i = index.home(h);
+    size_t probes = 0;
+    while (index.ctrl[i] != kEmpty && index.ctrl[i] != kErased) {
+        i = (i + 1) & mask;
+        ++probes;
+    }
+    trace_probe(probes);
+    if (index.ctrl[i] == kErased) {
+        --index.erased;
+    }
+    index.ctrl[i] = fingerprint(h);
+    index.slots[i] = position;
+}
+
+// Mark the slot for the entry at `position` erased, if the index has one
+template <typename Key, typename Value, typename Alloc, typename Trace>
+void HashTable<Key, Value, Alloc, Trace>::forget(Index& index, const Key& key, uint32_t position) {
+    size_t slot = slot_of(index, key, position);
+    if (slot != kNoSlot) {
+        index.ctrl[slot] = kErased;
+        ++index.erased;
+    }
+}
+
+// Point the slot for the entry at `from` to `to`, if the index has one
+template <typename Key, typename Value, typename Alloc, typename Trace>
+void HashTable<Key, Value, Alloc, Trace>::repoint(Index& index, const Key& key, uint32_t from, uint32_t to) {
+    size_t slot = slot_of(index, key, from);
+    if (slot != kNoSlot) {
+        index.slots[slot] = to;
+    }
+}
+
+// Rehash function: rebuild the index only, entries stay where they are. In
+// incremental mode the new index starts empty and fills as rehash_step()
+// drains the old one.
+template <typename Key, typename Value, typename Alloc, typename Trace>
+void HashTable<Key, Value, Alloc, Trace>::rehash(size_t new_capacity) {
+    finish_rehash();
+    TraceScope<Trace> scope(TraceEvent::Rehash, new_capacity);
+    if (incremental_ && !entries_.empty()) {
+        Trace::async_begin(TraceEvent::Migrate, trace_id());
+        std::swap(old_, index_);
+        allocate_index(index_, new_capacity);
+        migrate_pos_ = 0;
+        rehash_step();
+        return;
+    }
+    rebuild_index(new_capacity);
+}
+
+// Replace the index with one of `capacity` slots built from every entry
+template <typename Key, typename Value, typename Alloc, typename Trace>
+void HashTable<Key, Value, Alloc, Trace>::rebuild_index(size_t capacity) {
+    release_index(index_);
+    allocate_index(index_, capacity);
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        place(index_, hash(entries_[i].key), static_cast<uint32_t>(i));
+    }
+}
+
+// Allocate an empty index of `capacity` slots
+template <typename Key, typename Value, typename Alloc, typename Trace>
+void HashTable<Key, Value, Alloc, Trace>::allocate_index(Index& index, size_t capacity) {
+    TraceScope<Trace> scope(TraceEvent::Allocate, capacity);
+    void* block = alloc_.allocate(Index::bytes(capacity), alignof(uint32_t));
+    index.ctrl = static_cast<uint8_t*>(block);
+    index.slots = reinterpret_cast<uint32_t*>(index.ctrl + capacity); // capacity >= 16 keeps this aligned
+    index.capacity = capacity;
+    index.erased = 0;
+    std::memset(index.ctrl, kEmpty, capacity);
+}
+
+// Free an index's arrays, leaving it unused
+template <typename Key, typename Value, typename Alloc, typename Trace>
+void HashTable<Key, Value, Alloc, Trace>::release_index(Index& index) {
+    if (index.capacity != 0) {
+        alloc_.deallocate(index.ctrl, Index::bytes(index.capacity), alignof(uint32_t));
+    }
+    index = Index{};
+}
+
+// Complete an in-progress rehash in one go
+template <typename Key, typename Value, typename Alloc, typename Trace>
+void HashTable<Key, Value, Alloc, Trace>::finish_rehash() {
+    while (rehashing()) {
+        rehash_step(old_.capacity);
+    }
+}
+
+// Run a function on several threads
+template <typename Key, typename Value, typename Alloc, typename Trace>
+template <typename Fn>
+void HashTable<Key, Value, Alloc, Trace>::run_parallel(size_t threads, Fn&& fn) {
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (size_t t = 1; t < threads; ++t) {
+        workers.emplace_back(fn, t);
+    }
+    fn(0);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
 }
 
 #endif // HASHTABLE_HPP
@@ -0,0 +1,111 @@
+// hybrid_cache.hpp
+
+#pragma once
+
+#ifndef HYBRID_CACHE_HPP
+#define HYBRID_CACHE_HPP
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "disk_tier.hpp"
+#include "lru.hpp"
+#include "snapshot.hpp"
+
+// Two-tier cache: an in-memory LRUCache in front of a DiskTier on a local
+// file. Entries evicted from memory are serialized (with the same
+// serializers as snapshots, see snapshot.hpp) and appended to the disk tier
+// instead of being lost; a miss in memory checks the disk tier and promotes
+// a hit back into memory, which may in turn spill another entry to disk.
+//
+// An entry lives in exactly one tier at a time. The disk tier drops its
+// oldest segment when it wraps, so the total reach is the memory capacity
+// plus roughly the file size in serialized values.
+template <typename Key, typename Value, typename ValueSerializer = SnapshotSerializer<Value>>
+class HybridCache {
+public:
+    HybridCache(size_t capacity, const std::string& path, size_t segment_size = size_t(1) << 20,
+                size_t segment_count = 64)
+        : memory_(capacity), disk_(path, segment_size, segment_count) {
+        if (capacity == 0) {
+            // put() and promotions hand the entry to the memory tier, which
+            // would drop it
+            throw std::invalid_argument("HybridCache needs a memory capacity of at least 1");
+        }
+        memory_.set_eviction_listener([this](const Key& key, Value& value) { spill(key, value); });
+    }
+
+    HybridCache(const HybridCache&) = delete;
+    HybridCache& operator=(const HybridCache&) = delete;
+
+    void put(const Key& key, const Value& value) {
+        disk_.erase(key); // The copy in memory is now the only one
+        memory_.put(key, value);
+    }
+
+    Value get(const Key& key) {
+        Value* value = find(key);
+        if (!value) {
+            throw std::runtime_error("Key not found");
+        }
+        return *value;
+    }
+
+    // Like get(), but returns nullptr instead of throwing on a miss. The
+    // pointer is valid until the next call that modifies the cache.
+    Value* find(const Key& key) {
+        if (Value* value = memory_.find(key)) {
+            return value;
+        }
+        if (!disk_.get(key, bytes_)) {
+            return nullptr;
+        }
+        // Drop the disk copy only once the value is safely in memory, so
+        // that a record that fails to decode is not lost from both tiers
+        SnapshotReader in(bytes_.data(), bytes_.size());
+        memory_.put(key, ValueSerializer::read(in));
+        disk_.erase(key);
+        ++promotions_;
+        return memory_.find(key);
+    }
+
+    bool contains(const Key& key) const {
+        return memory_.contains(key) || disk_.contains(key);
+    }
+
+    bool erase(const Key& key) {
+        bool in_memory = memory_.erase(key);
+        return disk_.erase(key) || in_memory;
+    }
+
+    // Write out values still buffered for the disk tier
+    void flush() { disk_.flush(); }
+
+    size_t memory_size() const { return memory_.size(); }
+    size_t disk_size() const { return disk_.size(); }
+    size_t spills() const { return spills_; }         // Entries written to disk
+    size_t promotions() const { return promotions_; } // Disk hits moved to memory
+
+    // Heap bytes held, including the disk tier's index and buffer
+    size_t memory_usage() const {
+        return memory_.memory_usage() + disk_.memory_usage();
+    }
+
+private:
+    LRUCache<Key, Value> memory_;
+    DiskTier<Key> disk_;
+    std::ostringstream out_; // Serialization buffer for spills
+    std::string bytes_;      // Read buffer for promotions
+    size_t spills_ = 0;
+    size_t promotions_ = 0;
+
+    void spill(const Key& key, const Value& value) {
+        out_.str(std::string());
+        ValueSerializer::write(out_, value);
+        if (disk_.put(key, out_.str())) {
+            ++spills_;
+        }
+    }
+};
+
+#endif // HYBRID_CACHE_HPP
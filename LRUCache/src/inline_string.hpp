@@ -0,0 +1,69 @@
+// inline_string.hpp
+
+#pragma once
+
+#ifndef INLINE_STRING_HPP
+#define INLINE_STRING_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Fixed-capacity string stored entirely inline: `Capacity` characters plus a
+// length byte, with no heap allocation. Meant as a compact key type for
+// caches keyed by short strings (InlineString<15> is 16 bytes, where a
+// std::string is 32 bytes plus an allocation past its SSO limit).
+template <size_t Capacity>
+class InlineString {
+    static_assert(Capacity > 0 && Capacity < 256, "InlineString length must fit in one byte");
+
+public:
+    InlineString() : data_{}, size_(0) {}
+
+    InlineString(std::string_view text) : data_{}, size_(0) {
+        if (text.size() > Capacity) {
+            throw std::length_error("String too long for InlineString");
+        }
+        std::memcpy(data_, text.data(), text.size());
+        size_ = static_cast<uint8_t>(text.size());
+    }
+
+    InlineString(const char* text) : InlineString(std::string_view(text)) {}
+    InlineString(const std::string& text) : InlineString(std::string_view(text)) {}
+
+    std::string_view view() const { return std::string_view(data_, size_); }
+    std::string str() const { return std::string(view()); }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    static constexpr size_t capacity() { return Capacity; }
+
+    friend bool operator==(const InlineString& a, const InlineString& b) {
+        return a.size_ == b.size_ && std::memcmp(a.data_, b.data_, a.size_) == 0;
+    }
+
+    friend bool operator!=(const InlineString& a, const InlineString& b) {
+        return !(a == b);
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const InlineString& s) {
+        return out << s.view();
+    }
+
+private:
+    char data_[Capacity];
+    uint8_t size_;
+};
+
+template <size_t Capacity>
+struct std::hash<InlineString<Capacity>> {
+    size_t operator()(const InlineString<Capacity>& s) const {
+        return std::hash<std::string_view>{}(s.view());
+    }
+};
+
+#endif // INLINE_STRING_HPP
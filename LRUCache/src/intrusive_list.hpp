@@ -7,6 +7,7 @@
 
 #include <iterator>
 #include <cassert>
+#include <cstdint>
 
 template <typename T>
 class IntrusiveList {
@@ -137,4 +138,106 @@ private:
     size_t size_;
 };
 
+// Links embedded in an element that lives in external indexed storage.
+// Indices are 31 bits wide, which leaves a spare bit for the owner.
+struct IndexLinks {
+    uint32_t prev;
+    uint32_t next : 31;
+    uint32_t tag : 1;  // Free for the owner's use; IndexList never changes it
+};
+
+// Doubly linked list threaded through elements addressed by a 32-bit index,
+// for example the entries of a HashTable. The list owns no storage: every
+// operation that touches links takes `links`, a callable mapping an index to
+// that element's IndexLinks.
+class IndexList {
+public:
+    static constexpr uint32_t npos = 0x7FFFFFFF;
+
+    IndexList() : head(npos), tail(npos), size_(0) {}
+
+    template <typename Links>
+    void push_front(uint32_t index, Links&& links) {
+        IndexLinks& node = links(index);
+        node.prev = npos;
+        node.next = head;
+        if (head != npos) {
+            links(head).prev = index;
+        }
+        else {
+            tail = index;
+        }
+        head = index;
+        ++size_;
+    }
+
+    template <typename Links>
+    void push_back(uint32_t index, Links&& links) {
+        IndexLinks& node = links(index);
+        node.prev = tail;
+        node.next = npos;
+        if (tail != npos) {
+            links(tail).next = index;
+        }
+        else {
+            head = index;
+        }
+        tail = index;
+        ++size_;
+    }
+
+    template <typename Links>
+    void remove(uint32_t index, Links&& links) {
+        IndexLinks& node = links(index);
+        if (node.prev != npos) {
+            links(node.prev).next = node.next;
+        }
+        else {
+            head = node.next; // Node is the head
+        }
+        if (node.next != npos) {
+            links(node.next).prev = node.prev;
+        }
+        else {
+            tail = node.prev; // Node is the tail
+        }
+        --size_;
+    }
+
+    template <typename Links>
+    void move_to_front(uint32_t index, Links&& links) {
+        if (index == head) return; // Already at the front
+        remove(index, links);
+        push_front(index, links);
+    }
+
+    // The element at `from` (links included) now lives at `to`; repoint
+    // its neighbours
+    template <typename Links>
+    void relocate(uint32_t from, uint32_t to, Links&& links) {
+        IndexLinks& node = links(to);
+        if (node.prev != npos) links(node.prev).next = to;
+        if (node.next != npos) links(node.next).prev = to;
+        if (head == from) head = to;
+        if (tail == from) tail = to;
+    }
+
+    uint32_t front() const { return head; }
+    uint32_t back() const { return tail; }
+
+    void clear() {
+        head = npos;
+        tail = npos;
+        size_ = 0;
+    }
+
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+
+private:
+    uint32_t head;
+    uint32_t tail;
+    size_t size_;
+};
+
 #endif // INTRUSIVE_LIST_HPP
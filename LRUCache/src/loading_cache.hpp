@@ -0,0 +1,310 @@
+// loading_cache.hpp
+
+#pragma once
+
+#ifndef LOADING_CACHE_HPP
+#define LOADING_CACHE_HPP
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "lru.hpp"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define LOADING_CACHE_HAS_COROUTINES 1
+#else
+#define LOADING_CACHE_HAS_COROUTINES 0
+#endif
+
+// Thread-safe cache that fills itself through a loader function.
+//
+// Concurrent misses on the same key share one in-flight load: the first
+// caller starts it and every other caller receives the same shared_future.
+// The loaded value is inserted once, when the load completes. Failed loads
+// are not cached; their exception is delivered to every waiter.
+//
+// Entries expire `ttl` after they were loaded. When `refresh_after` is
+// shorter than `ttl`, a hit on an entry older than `refresh_after` returns
+// the current value immediately and reloads it in the background.
+//
+// Loads run on the executor passed to the constructor. Without one, the
+// caller that starts a load runs it before get_async() returns, so a
+// refresh window needs an executor: a hit must not wait for a reload. An
+// executor must finish all submitted work before the cache is destroyed.
+//
+// Under C++20, co_get() and co_get_or_load() return awaitables that complete
+// without suspending on a hit and allocate nothing; the awaiting coroutine is
+// suspended only while a load for the key is pending, and is resumed on the
+// thread that finishes the load.
+template <typename Key, typename Value, typename Clock = std::chrono::steady_clock>
+class LoadingCache {
+public:
+    using Loader = std::function<Value(const Key&)>;
+    using Executor = std::function<void(std::function<void()>)>;
+    using Duration = typename Clock::duration;
+
+    explicit LoadingCache(size_t capacity, Duration ttl = Duration::max(),
+                          Duration refresh_after = Duration::max(), Executor executor = {})
+        : cache_(capacity), ttl_(ttl), refresh_after_(refresh_after), executor_(std::move(executor)) {
+        if (refresh_after_ < ttl_ && !executor_) {
+            throw std::invalid_argument("LoadingCache refresh-ahead needs an executor");
+        }
+    }
+
+    std::shared_future<Value> get_async(const Key& key, Loader loader) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (std::optional<Value> value = lookup(lock, key, loader)) {
+            std::promise<Value> promise;
+            promise.set_value(std::move(*value));
+            return promise.get_future().share();
+        }
+        auto pending = in_flight_.find(key);
+        if (pending != in_flight_.end()) {
+            return pending->second->future;
+        }
+        return start_load(lock, key, std::move(loader))->future;
+    }
+
+    // Blocking form of get_async()
+    Value get(const Key& key, Loader loader) {
+        return get_async(key, std::move(loader)).get();
+    }
+
+    // Current unexpired value, without loading
+    std::optional<Value> get_if_present(const Key& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stamped* entry = cache_.find(key);
+        if (!entry || Clock::now() - entry->loaded_at >= ttl_) {
+            return std::nullopt;
+        }
+        return entry->value;
+    }
+
+    void put(const Key& key, const Value& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cache_.put(key, { value, Clock::now() });
+    }
+
+    bool contains(const Key& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return cache_.contains(key);
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return cache_.size();
+    }
+
+    // Number of loads currently running
+    size_t loads_in_flight() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return in_flight_.size();
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cache_.clear();
+    }
+
+#if LOADING_CACHE_HAS_COROUTINES
+    // Awaitable yielding the cached value, or std::nullopt on a miss. Waits
+    // for a load of the key that is already in flight, but never starts one.
+    class GetAwaiter {
+    public:
+        GetAwaiter(LoadingCache& cache, const Key& key) : cache_(cache), key_(key) {}
+
+        bool await_ready() {
+            std::unique_lock<std::mutex> lock(cache_.mutex_);
+            value_ = cache_.lookup(lock, key_, {});
+            return value_ || cache_.in_flight_.find(key_) == cache_.in_flight_.end();
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            std::unique_lock<std::mutex> lock(cache_.mutex_);
+            auto pending = cache_.in_flight_.find(key_);
+            if (pending == cache_.in_flight_.end()) {
+                value_ = cache_.lookup(lock, key_, {}); // Finished in the meantime
+                return false;
+            }
+            future_ = pending->second->future;
+            pending->second->continuations.push_back([handle] { handle.resume(); });
+            return true;
+        }
+
+        std::optional<Value> await_resume() {
+            if (future_.valid()) {
+                return future_.get();
+            }
+            return std::move(value_);
+        }
+
+    private:
+        LoadingCache& cache_;
+        Key key_;
+        std::optional<Value> value_;
+        std::shared_future<Value> future_;
+    };
+
+    // Awaitable yielding the value for `key`, loading it on a miss exactly as
+    // get_async() would. Load failures are rethrown from the co_await.
+    class LoadAwaiter {
+    public:
+        LoadAwaiter(LoadingCache& cache, const Key& key, Loader loader)
+            : cache_(cache), key_(key), loader_(std::move(loader)) {
+        }
+
+        bool await_ready() {
+            std::unique_lock<std::mutex> lock(cache_.mutex_);
+            value_ = cache_.lookup(lock, key_, loader_);
+            return value_.has_value();
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            std::unique_lock<std::mutex> lock(cache_.mutex_);
+            if ((value_ = cache_.lookup(lock, key_, loader_))) {
+                return false;
+            }
+            auto pending = cache_.in_flight_.find(key_);
+            if (pending != cache_.in_flight_.end()) {
+                future_ = pending->second->future;
+                pending->second->continuations.push_back([handle] { handle.resume(); });
+                return true;
+            }
+            if (!cache_.executor_) {
+                // The load runs right here, so there is nothing to wait for
+                future_ = cache_.start_load(lock, key_, std::move(loader_))->future;
+                return false;
+            }
+            // Once the load is submitted the coroutine can be resumed (and
+            // destroyed) on another thread, so the awaiter is set up first.
+            auto flight = cache_.register_load(key_);
+            future_ = flight->future;
+            flight->continuations.push_back([handle] { handle.resume(); });
+            LoadingCache& cache = cache_;
+            cache.run_load(lock, key_, std::move(loader_), std::move(flight));
+            return true;
+        }
+
+        Value await_resume() {
+            if (value_) {
+                return std::move(*value_);
+            }
+            return future_.get();
+        }
+
+    private:
+        LoadingCache& cache_;
+        Key key_;
+        Loader loader_;
+        std::optional<Value> value_;
+        std::shared_future<Value> future_;
+    };
+
+    GetAwaiter co_get(const Key& key) {
+        return GetAwaiter(*this, key);
+    }
+
+    LoadAwaiter co_get_or_load(const Key& key, Loader loader) {
+        return LoadAwaiter(*this, key, std::move(loader));
+    }
+#endif
+
+private:
+    struct Stamped {
+        Value value;
+        typename Clock::time_point loaded_at;
+    };
+
+    struct Flight {
+        std::promise<Value> promise;
+        std::shared_future<Value> future;
+        std::vector<std::function<void()>> continuations; // Run once the load completes
+    };
+
+    // Unexpired cached value. With a loader, an entry old enough is also
+    // refreshed ahead of expiry, which releases the lock for a while.
+    std::optional<Value> lookup(std::unique_lock<std::mutex>& lock, const Key& key, const Loader& loader) {
+        Stamped* entry = cache_.find(key);
+        if (!entry) {
+            return std::nullopt;
+        }
+        auto age = Clock::now() - entry->loaded_at;
+        if (age >= ttl_) {
+            return std::nullopt;
+        }
+        std::optional<Value> value(entry->value);
+        if (loader && age >= refresh_after_ && in_flight_.find(key) == in_flight_.end()) {
+            start_load(lock, key, loader);
+            lock.lock();
+        }
+        return value;
+    }
+
+    std::shared_ptr<Flight> start_load(std::unique_lock<std::mutex>& lock, const Key& key, Loader loader) {
+        std::shared_ptr<Flight> flight = register_load(key);
+        run_load(lock, key, std::move(loader), flight);
+        return flight;
+    }
+
+    // Publishes a new in-flight load; the lock must be held
+    std::shared_ptr<Flight> register_load(const Key& key) {
+        auto flight = std::make_shared<Flight>();
+        flight->future = flight->promise.get_future().share();
+        in_flight_.emplace(key, flight);
+        return flight;
+    }
+
+    // Releases the lock and runs or submits the load. `key` is copied before
+    // the load can start, so it may refer to an object the load destroys.
+    void run_load(std::unique_lock<std::mutex>& lock, const Key& key, Loader loader,
+                  std::shared_ptr<Flight> flight) {
+        std::function<void()> task = [this, key, loader = std::move(loader), flight = std::move(flight)]() {
+            try {
+                Value value = loader(key);
+                {
+                    std::lock_guard<std::mutex> guard(mutex_);
+                    cache_.put(key, { value, Clock::now() });
+                    in_flight_.erase(key);
+                }
+                flight->promise.set_value(std::move(value));
+            }
+            catch (...) {
+                {
+                    std::lock_guard<std::mutex> guard(mutex_);
+                    in_flight_.erase(key);
+                }
+                flight->promise.set_exception(std::current_exception());
+            }
+            // The flight is unpublished, so no waiter can be added any more
+            for (auto& resume : flight->continuations) {
+                resume();
+            }
+        };
+
+        lock.unlock();
+        if (executor_) {
+            executor_(std::move(task));
+        }
+        else {
+            task();
+        }
+    }
+
+    std::mutex mutex_;
+    LRUCache<Key, Stamped> cache_;
+    std::unordered_map<Key, std::shared_ptr<Flight>> in_flight_;
+    Duration ttl_;
+    Duration refresh_after_;
+    Executor executor_;
+};
+
+#endif // LOADING_CACHE_HPP
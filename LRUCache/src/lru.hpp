@@ -1,114 +1,847 @@
 #pragma once
-#include <iostream>
+#include <cassert>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 #include "intrusive_list.hpp"
 #include "hashtable.hpp"
+#include "snapshot.hpp"
+#include "mrc.hpp"
 
-template <typename Key, typename Value>
+// LRUCache::dump() is a debugging aid and only exists in debug builds, or
+// when this is defined to 1; see lru_debug.hpp for printers built on it
+#ifndef LRUCACHE_DEBUG_API
+#ifdef NDEBUG
+#define LRUCACHE_DEBUG_API 0
+#else
+#define LRUCACHE_DEBUG_API 1
+#endif
+#endif
+
+// Order of the arrays passed to LRUCache::bulk_load()
+enum class Recency {
+    MostRecentFirst,
+    LeastRecentFirst,
+};
+
+// Entries are stored once, in the HashTable's dense storage; the recency list
+// is threaded through them by index, so an entry costs its key, its value and
+// two 32-bit links plus the table's 5-byte index slot, with no allocation of
+// its own. `Alloc` supplies that storage (see allocator.hpp); use
+// HugePageAllocator to back a large cache with huge pages on a NUMA node.
+// `Trace` (see trace.hpp) records put, eviction, growth and the table's
+// rehash and probe events; RingTrace captures them for a Chrome trace dump.
+//
+// With a protected ratio the cache runs as a segmented LRU (SLRU): new
+// entries start on a probation list and move to the protected list when hit
+// again, and protected overflow is demoted back to probation. Eviction takes
+// the probation tail first, so a burst of one-off keys only churns probation
+// while entries that were hit again stay protected. The segment is kept in
+// the spare bit of each entry's links, so this costs no extra memory.
+//
+// Entries can be put with an 8-bit tag, and invalidate_tag() makes every
+// entry carrying a tag stale in O(1): each entry records its tag and the
+// tag's generation, and bumping the generation orphans them all at once.
+// Stale entries are never returned; they are dropped when next looked up or
+// by purge_stale(), and otherwise age out like any other entry (size()
+// counts them until then). Tag words live in an array parallel to the
+// table's storage that only exists once a tag is used.
+//
+// Iteration runs MRU -> LRU (the protected segment first in SLRU mode) and
+// neither allocates nor touches entries. Any call that reorders or changes
+// the set of entries (put, get, find, erase, clear, load, bulk_load)
+// invalidates iterators; debug builds assert on the use of an invalidated
+// iterator.
+template <typename Key, typename Value, typename Alloc = DefaultAllocator, typename Trace = NoTrace>
 class LRUCache {
+    template <bool Const>
+    class BasicIterator;
+
 public:
-    explicit LRUCache(size_t capacity) : capacity_(capacity) {}
-    void put(const Key& key, const Value& value) {
-        auto* existing_entry = map_.find(key);
-        if (capacity_ == 0) {
-            return;
+    // An entry as seen through an iterator
+    template <bool Const>
+    struct Item {
+        const Key& key;
+        std::conditional_t<Const, const Value&, Value&> value;
+    };
+
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    static constexpr size_t kShrinkStep = 8; // Evictions per call while shrinking
+
+    explicit LRUCache(size_t capacity, const Alloc& alloc = Alloc()) : LRUCache(capacity, 0.0, alloc) {}
+
+    // `protected_ratio` in [0, 1) is the share of the capacity reserved for
+    // the protected segment; 0 is plain LRU
+    LRUCache(size_t capacity, double protected_ratio, const Alloc& alloc = Alloc())
+        : map_(16, alloc), capacity_(capacity), protected_capacity_(0), protected_ratio_(protected_ratio),
+          segmented_(protected_ratio > 0), version_(0) {
+        if (capacity_ >= IndexList::npos) {
+            throw std::invalid_argument("LRUCache capacity is too large");
         }
-        if (existing_entry != nullptr) {
-            // Update the value and move the node to the front
-            auto* node = *existing_entry;       // Dereference to get the Node*
-            node->data.value = value;          // Update the value
-            touch(node);                       // Move to the front
-        }
-        else {
-            // Evict the least recently used item if at capacity
-            if (list_.size() == capacity_) {
-                evict();
-            }
-            // Add a new node to the front of the list
-            list_.push_front({ key, value });
-            auto* new_node = list_.head_node(); // Get the head node
-            map_.insert(key, new_node);        // Add the Node* to the hash table
+        if (!(protected_ratio >= 0 && protected_ratio < 1)) {
+            throw std::invalid_argument("LRUCache protected ratio must be in [0, 1)");
         }
+        protected_capacity_ = static_cast<size_t>(static_cast<double>(capacity_) * protected_ratio);
+    }
+
+    // An existing entry keeps its tag; a new one gets tag 0
+    void put(const Key& key, const Value& value) {
+        store(key, value, kKeepTag);
     }
 
+    // Put with an invalidation tag; see invalidate_tag()
+    void put(const Key& key, const Value& value, uint8_t tag) {
+        enable_tags();
+        store(key, value, tag);
+    }
 
     Value get(const Key& key) {
-        auto* entry = map_.find(key);  // Find the entry in the hash table
-        if (!entry) {
+        observe(key);
+        if (shrinking()) {
+            shrink_step();
+        }
+        uint32_t index = live_index(key);        // Find the entry in the hash table
+        if (index == Map::npos) {
             throw std::runtime_error("Key not found");
         }
-        auto* node = (*entry);        // Dereference to access the Node* stored as value
-        touch(node);                  // Move the node to the front
-        return node->data.value;      // Return the associated value
+        touch(index);                            // Move the entry to the front
+        return map_.entry_at(index).value.value; // Return the associated value
+    }
+
+    // Like get(), but returns nullptr instead of throwing on a miss. The
+    // pointer is valid until the next call that modifies the cache.
+    Value* find(const Key& key) {
+        observe(key);
+        if (shrinking()) {
+            shrink_step();
+        }
+        uint32_t index = live_index(key);
+        if (index == Map::npos) {
+            return nullptr;
+        }
+        touch(index);
+        return &map_.entry_at(index).value.value;
     }
 
     size_t size() const {
-        return list_.size();
+        return list_.size() + probation_.size();
+    }
+
+    size_t capacity() const { return capacity_; }
+
+    // Change the capacity without losing the contents. Growing takes
+    // effect at once; storage then grows on demand, as it does up to the
+    // initial capacity. Shrinking evicts least recently used entries
+    // (through the eviction listener), at most kShrinkStep here and per
+    // later put, get or find, so a large shrink never stalls one call;
+    // until it is done size() may exceed capacity().
+    void set_capacity(size_t capacity) {
+        if (capacity >= IndexList::npos) {
+            throw std::invalid_argument("LRUCache capacity is too large");
+        }
+        capacity_ = capacity;
+        protected_capacity_ = static_cast<size_t>(static_cast<double>(capacity_) * protected_ratio_);
+        ++version_;
+        shrink_step();
+    }
+
+    // True while a shrink started by set_capacity() is still evicting
+    bool shrinking() const {
+        return size() > capacity_ || (segmented_ && list_.size() > protected_capacity_);
+    }
+
+    // Demote and evict up to `entries` entries each towards the capacity;
+    // lets an idle caller finish a shrink that requests would otherwise drive
+    void shrink_step(size_t entries = kShrinkStep) {
+        for (size_t n = entries; n > 0 && segmented_ && list_.size() > protected_capacity_; --n) {
+            demote();
+            ++version_;
+        }
+        for (size_t n = entries; n > 0 && size() > capacity_; --n) {
+            evict();
+        }
+    }
+
+    // Evict least recently used entries (through the eviction listener)
+    // until at most `entries` remain, in one batch. The capacity is
+    // unchanged. Returns the number evicted.
+    size_t evict_to(size_t entries) {
+        size_t evicted = 0;
+        for (; size() > entries; ++evicted) {
+            evict();
+        }
+        return evicted;
+    }
+
+    // Return storage and index memory beyond what the current entries need
+    // to the allocator. Storage grows back on demand as the cache refills.
+    void shrink_to_fit() {
+        map_.shrink_to_fit();
+        if (tagged_) {
+            tags_.shrink_to_fit();
+        }
+    }
+
+    // Evict least recently used entries holding about `bytes` of storage
+    // and return the freed memory, for callers under memory pressure (see
+    // memory_pressure.hpp). Returns the number of entries evicted.
+    size_t release_memory(size_t bytes) {
+        size_t evicted = 0;
+        if (size() > 0) {
+            size_t per_entry = memory_usage() / size();
+            size_t count = per_entry == 0 ? size() : (bytes + per_entry - 1) / per_entry;
+            evicted = evict_to(count < size() ? size() - count : 0);
+        }
+        shrink_to_fit();
+        return evicted;
+    }
+
+    // Estimate from here on the hit ratio the cache would have at other
+    // capacities, up to `max_capacity` (see mrc.hpp). The estimate is for
+    // plain LRU and counts get() and find() calls as requests.
+    void track_hit_ratio(size_t max_capacity, double sample_rate = 0.01) {
+        curve_ = std::make_unique<MissRatioCurve<Key>>(max_capacity, sample_rate);
+    }
+
+    // Estimated hit ratio at `capacity` entries; 0 when not tracking
+    double hit_ratio_at(size_t capacity) const {
+        return curve_ ? curve_->hit_ratio(capacity) : 0.0;
+    }
+
+    // The full estimate, or nullptr when not tracking
+    const MissRatioCurve<Key>* hit_ratio_curve() const { return curve_.get(); }
+
+    // Every `interval` requests, resize to the smallest capacity in
+    // [min_capacity, max_capacity] whose estimated hit ratio is within
+    // `tolerance` of the one at max_capacity, i.e. past which more memory
+    // buys little, then age the estimate so it follows the workload.
+    // Tracks the hit ratio if not already doing so.
+    void set_auto_resize(size_t min_capacity, size_t max_capacity, double tolerance = 0.01,
+                         uint64_t interval = 100000) {
+        if (min_capacity > max_capacity || interval == 0) {
+            throw std::invalid_argument("LRUCache auto-resize bounds are invalid");
+        }
+        if (!curve_ || curve_->max_capacity() < max_capacity) {
+            track_hit_ratio(max_capacity);
+        }
+        auto_resize_ = AutoResize{ min_capacity, max_capacity, tolerance, interval, interval };
+    }
+
+    void disable_auto_resize() { auto_resize_.reset(); }
+
+    // Entries in the protected segment; always 0 in plain LRU mode
+    size_t protected_size() const {
+        return segmented_ ? list_.size() : 0;
     }
 
     // Implement clear method
     void clear() {
-        // Clear the list
+        // Clear the lists
         list_.clear();
+        probation_.clear();
 
         // Clear the map
         map_.clear();
+        tags_.clear();
+        ++version_;
     }
 
-    bool contains(const Key& key) {
-        return map_.find(key) != nullptr;
+    // Hint that `key` is about to be looked up (see HashTable::prefetch)
+    void prefetch(const Key& key) const {
+        map_.prefetch(key);
     }
 
-    void display() {
-        for (auto it = list_.begin(); it != list_.end(); ++it) {
-            std::cout << it->key << ": " << it->value << " -> ";
+    bool contains(const Key& key) const {
+        uint32_t index = map_.find_index(key);
+        return index != Map::npos && !stale(index);
+    }
+
+    // Remove `key`; returns false if it was not cached (or already stale)
+    bool erase(const Key& key) {
+        uint32_t index = map_.find_index(key);
+        if (index == Map::npos) {
+            return false;
         }
-        std::cout << "NULL\n";
+        bool live = !stale(index);
+        remove_at(index);
+        return live;
+    }
+
+    // Remove every entry for which pred(key, value) is true in one pass
+    // over storage, compacting it as it goes; stale entries are dropped
+    // too. Returns the number of entries removed.
+    template <typename Pred>
+    size_t erase_if(Pred&& pred) {
+        return remove_where([&](uint32_t index) {
+            const auto& entry = map_.entry_at(index);
+            return stale(index) || pred(entry.key, entry.value.value);
+        });
     }
 
-    void print_state() {
-        std::cout << "List: ";
-        for (auto it = list_.begin(); it != list_.end(); ++it) {
-            std::cout << it->key << ": " << it->value << " -> ";
+    // Make every entry put with `tag` stale, in O(1). Entries put without
+    // a tag have tag 0.
+    void invalidate_tag(uint8_t tag) {
+        enable_tags();
+        if (generations_[tag] == kMaxGeneration) {
+            // Out of generations for this tag: drop its entries eagerly and
+            // start over, so that an old generation can never come back
+            remove_where([&](uint32_t index) { return (tags_[index] & 0xFF) == tag; });
+            generations_[tag] = 0;
+            return;
         }
-        std::cout << "NULL\n";
+        ++generations_[tag];
+    }
+
+    // Drop all stale entries now instead of as they are found. Returns the
+    // number dropped.
+    size_t purge_stale() {
+        return erase_if([](const Key&, const Value&) { return false; });
+    }
+
+    // fn(key, value) is called for each entry evicted to make room, just
+    // before it is dropped, and may move the value out. It is not called for
+    // erase(), clear() or stale entries, and must not modify the cache.
+    void set_eviction_listener(std::function<void(const Key&, Value&)> fn) {
+        on_evict_ = std::move(fn);
+    }
+
+    // Heap bytes held by the cache's storage
+    size_t memory_usage() const {
+        return map_.memory_usage() + tags_.capacity() * sizeof(uint32_t) +
+               generations_.capacity() * sizeof(uint32_t) + (curve_ ? curve_->memory_usage() : 0);
+    }
+
+    // Write every entry to `path` in MRU -> LRU order (protected segment
+    // first in SLRU mode). The snapshot is written next to `path` and moved
+    // over it once complete (see replace_snapshot_file), so a failed save
+    // leaves the previous snapshot intact.
+    template <typename KeySerializer = SnapshotSerializer<Key>,
+              typename ValueSerializer = SnapshotSerializer<Value>>
+    void save(const std::string& path) const {
+        std::string temp_path = path + ".tmp";
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Cannot create snapshot: " + temp_path);
+        }
+        SnapshotHeader header{};
+        std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+        header.version = kSnapshotVersion;
+        header.key_format = KeySerializer::format;
+        header.value_format = ValueSerializer::format;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        // Stale entries still count in size() but are skipped here, so the
+        // header is rewritten with the number actually written
+        for (auto [key, value] : *this) {
+            KeySerializer::write(out, key);
+            ValueSerializer::write(out, value);
+            ++header.count;
+        }
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.close();
+        if (!out) {
+            std::remove(temp_path.c_str());
+            throw std::runtime_error("Failed to write snapshot: " + path);
+        }
+        if (!replace_snapshot_file(temp_path, path)) {
+            std::remove(temp_path.c_str());
+            throw std::runtime_error("Failed to replace snapshot: " + path);
+        }
+    }
 
-        std::cout << "Map: ";
-        for (auto& entry : map_) {
-            if (entry.is_active) { // Check if the entry is active
-                auto* node = entry.value; // This is a Node*
-                std::cout << entry.key << ": " << node->data.value << " -> ";
+    // Replace the contents with a snapshot written by save(). Only the
+    // `capacity_` most recently used entries are kept. Returns the number
+    // of entries loaded. A truncated or corrupt snapshot throws and leaves
+    // the current contents untouched.
+    template <typename KeySerializer = SnapshotSerializer<Key>,
+              typename ValueSerializer = SnapshotSerializer<Value>>
+    size_t load(const std::string& path) {
+        MappedFile file(path);
+        SnapshotReader in(file.data(), file.size());
+
+        SnapshotHeader header;
+        std::memcpy(&header, in.take(sizeof(header)), sizeof(header));
+        if (std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0 ||
+            header.version != kSnapshotVersion) {
+            throw std::runtime_error("Not a snapshot file: " + path);
+        }
+        if (header.key_format != KeySerializer::format ||
+            header.value_format != ValueSerializer::format) {
+            throw std::runtime_error("Snapshot was written for different key/value types");
+        }
+
+        // Check that every record is there before dropping anything, so
+        // that a bad file throws with the cache as it was
+        size_t count = header.count < capacity_ ? static_cast<size_t>(header.count) : capacity_;
+        SnapshotReader check = in;
+        for (size_t i = 0; i < count; ++i) {
+            snapshot_skip<KeySerializer>(check);
+            snapshot_skip<ValueSerializer>(check);
+        }
+
+        clear();
+        map_.reserve(count); // Build the index once instead of rehashing as it fills
+        for (size_t i = 0; i < count; ++i) {
+            Key key = KeySerializer::read(in);
+            Value value = ValueSerializer::read(in);
+            if (map_.find_index(key) != Map::npos) continue; // Keep the most recent copy
+            // Entries arrive hottest first, so each one goes behind the last;
+            // in SLRU mode the protected segment is refilled first
+            map_.insert(key, CacheEntry{ std::move(value), {} });
+            if (tagged_) {
+                tags_.push_back(tag_word(0));
+            }
+            uint32_t index = static_cast<uint32_t>(map_.size() - 1);
+            if (segmented_ && list_.size() >= protected_capacity_) {
+                map_.entry_at(index).value.links.tag = kProbation;
+                probation_.push_back(index, links());
+            }
+            else {
+                list_.push_back(index, links());
+            }
+        }
+        return size();
+    }
+
+    // Replace the contents with keys[i] -> values[i], given in `order` of
+    // recency. Faster than putting them one at a time: the table is sized
+    // and indexed in one go, on up to `threads` threads (see
+    // HashTable::insert_bulk), and the recency lists are linked in one
+    // pass. Only the `capacity_` most recent distinct keys are loaded, and
+    // of a repeated key its most recent copy. Returns the number of entries
+    // loaded.
+    size_t bulk_load(const std::vector<Key>& keys, const std::vector<Value>& values,
+                     Recency order = Recency::MostRecentFirst, size_t threads = 1) {
+        if (keys.size() != values.size()) {
+            throw std::invalid_argument("bulk_load needs one value per key");
+        }
+        clear();
+        size_t count = keys.size() < capacity_ ? keys.size() : capacity_;
+        size_t last = keys.empty() ? 0 : keys.size() - 1;
+        bool reversed = order == Recency::LeastRecentFirst;
+        auto key_at = [&](size_t i) -> const Key& { return keys[reversed ? last - i : i]; };
+        auto value_at = [&](size_t i) { return CacheEntry{ values[reversed ? last - i : i], {} }; };
+        map_.insert_bulk(count, key_at, value_at, threads);
+        // Repeated keys among the first `count` leave room; fill it from the
+        // rest of the input, colder keys after hotter ones, as put() would
+        for (size_t i = count; map_.size() < capacity_ && i < keys.size(); ++i) {
+            if (map_.find_index(key_at(i)) == Map::npos) {
+                map_.insert(key_at(i), value_at(i));
+            }
+        }
+        if (tagged_) {
+            while (tags_.size() < map_.size()) {
+                tags_.push_back(tag_word(0));
+            }
+        }
+        // Table positions are in recency order, hottest first; in SLRU mode
+        // the protected segment is filled first
+        for (uint32_t index = 0; index < map_.size(); ++index) {
+            if (segmented_ && list_.size() >= protected_capacity_) {
+                map_.entry_at(index).value.links.tag = kProbation;
+                probation_.push_back(index, links());
+            }
+            else {
+                list_.push_back(index, links());
             }
         }
+        return size();
+    }
+
+    iterator begin() { return iterator(this, first()); }
+    iterator end() { return iterator(this, IndexList::npos); }
+    const_iterator begin() const { return const_iterator(this, first()); }
+    const_iterator end() const { return const_iterator(this, IndexList::npos); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
 
-        std::cout << "NULL\n";
+    // Call fn(key, value) for the `n` most recently used entries, hottest
+    // first, without touching them
+    template <typename Fn>
+    void for_each_hottest(size_t n, Fn&& fn) const {
+        for (auto it = begin(); n > 0 && it != end(); ++it, --n) {
+            auto item = *it;
+            fn(item.key, item.value);
+        }
     }
 
+    // Call fn(key, value) for the `n` least recently used entries, coldest
+    // first (the next eviction victim first), without touching them
+    template <typename Fn>
+    void for_each_coldest(size_t n, Fn&& fn) const {
+        for (const IndexList* list : { &probation_, &list_ }) {
+            for (uint32_t index = list->back(); n > 0 && index != IndexList::npos;) {
+                const auto& entry = map_.entry_at(index);
+                if (!stale(index)) {
+                    fn(entry.key, entry.value.value);
+                    --n;
+                }
+                index = entry.value.links.prev;
+            }
+        }
+    }
 
+#if LRUCACHE_DEBUG_API
+    // Debug dump: sink(key, value) for every entry MRU -> LRU, then
+    // sink(key, value) for every entry in table storage order, with a call
+    // to sink.section(name) before each pass
+    template <typename Sink>
+    void dump(Sink&& sink) const {
+        sink.section("List");
+        for (auto [key, value] : *this) {
+            sink(key, value);
+        }
+        sink.section("Map");
+        for (const auto& entry : map_) {
+            sink(entry.key, entry.value.value);
+        }
+    }
+#endif
 
 private:
+    // The key is the table's; only the value and recency links are added
     struct CacheEntry {
-        Key key;
         Value value;
+        IndexLinks links;
     };
 
-    IntrusiveList<CacheEntry> list_;
-    HashTable<Key, typename IntrusiveList<CacheEntry>::Node*> map_;
+    using Map = HashTable<Key, CacheEntry, Alloc, Trace>;
+
+    // Segment of an entry, kept in its links' tag bit
+    static constexpr uint32_t kProtected = 0;
+    static constexpr uint32_t kProbation = 1;
+
+    // Tag words are tag | generation << 8
+    static constexpr int kKeepTag = -1;
+    static constexpr uint32_t kMaxGeneration = (1u << 24) - 1;
+
+    IndexList list_;      // Whole recency order, or the protected segment
+    IndexList probation_; // Probation segment; empty in plain LRU mode
+    Map map_;
     size_t capacity_;
+    size_t protected_capacity_;
+    double protected_ratio_;
+    bool segmented_;
+    uint64_t version_; // Bumped whenever iterators are invalidated
+    bool tagged_ = false;
+    PagedVector<uint32_t> tags_;      // Per table position, once tagged_
+    std::vector<uint32_t> generations_; // Per tag, once tagged_
+    std::function<void(const Key&, Value&)> on_evict_;
+
+    struct AutoResize {
+        size_t min_capacity;
+        size_t max_capacity;
+        double tolerance;
+        uint64_t interval;
+        uint64_t countdown; // Requests until the next resize
+    };
+    static constexpr uint64_t kMinSampledForResize = 1000;
+
+    std::unique_ptr<MissRatioCurve<Key>> curve_; // Only while tracking
+    std::optional<AutoResize> auto_resize_;
+
+    // Accessor for the links of the entry at a table position
+    auto links() {
+        return [this](uint32_t index) -> IndexLinks& { return map_.entry_at(index).value.links; };
+    }
+
+    IndexList& segment_of(uint32_t index) {
+        return map_.entry_at(index).value.links.tag == kProbation ? probation_ : list_;
+    }
+
+    void store(const Key& key, const Value& value, int tag) {
+        TraceScope<Trace> scope(TraceEvent::Put);
+        if (shrinking()) {
+            shrink_step();
+        }
+        uint32_t existing = map_.find_index(key);
+        if (capacity_ == 0) {
+            return;
+        }
+        if (existing != Map::npos) {
+            // Update the value and move the entry to the front; a stale
+            // entry is as good as new, so it loses its old tag
+            map_.entry_at(existing).value.value = value;
+            if (tagged_ && (tag != kKeepTag || stale(existing))) {
+                tags_[existing] = tag_word(tag);
+            }
+            touch(existing);
+        }
+        else {
+            // Evict the least recently used item if at capacity (or still
+            // above it, shrinking)
+            if (size() >= capacity_) {
+                evict();
+            }
+            grow();
+            // New entries are appended to the table's storage
+            map_.insert(key, CacheEntry{ value, {} });
+            if (tagged_) {
+                tags_.push_back(tag_word(tag));
+            }
+            ++version_;
+            uint32_t index = static_cast<uint32_t>(map_.size() - 1);
+            if (segmented_) {
+                map_.entry_at(index).value.links.tag = kProbation;
+                probation_.push_front(index, links());
+            }
+            else {
+                list_.push_front(index, links());
+            }
+        }
+    }
+
+    // Position of `key` if cached and not stale; a stale entry found on
+    // the way is dropped
+    uint32_t live_index(const Key& key) {
+        uint32_t index = map_.find_index(key);
+        if (index != Map::npos && stale(index)) {
+            remove_at(index);
+            return Map::npos;
+        }
+        return index;
+    }
+
+    void enable_tags() {
+        if (tagged_) return;
+        generations_.assign(256, 0);
+        tags_.reserve(map_.entry_capacity());
+        while (tags_.size() < map_.size()) {
+            tags_.push_back(0); // Tag 0, generation 0
+        }
+        tagged_ = true;
+    }
+
+    uint32_t tag_word(int tag) const {
+        uint32_t t = tag == kKeepTag ? 0 : static_cast<uint32_t>(tag);
+        return t | generations_[t] << 8;
+    }
+
+    bool stale(uint32_t index) const {
+        if (!tagged_) return false;
+        uint32_t word = tags_[index];
+        return (word >> 8) != generations_[word & 0xFF];
+    }
 
-    void touch(typename IntrusiveList<CacheEntry>::Node* node) {
-        if (node == list_.head_node()) return; // Already at the front
-        list_.remove(node);                   // Remove the node from its current position
-        list_.push_front(node);               // Re-add the same node at the front
-        // No need to update map_ as it already points to the correct node
+    // Hottest entry: the protected (or only) list comes before probation
+    uint32_t first() const {
+        return skip_stale(list_.front() != IndexList::npos ? list_.front() : probation_.front());
     }
 
-  
+    // Successor in MRU -> LRU order, skipping stale entries
+    uint32_t next(uint32_t index) const {
+        return skip_stale(raw_next(index));
+    }
+
+    // Successor in MRU -> LRU order, crossing from list_ to probation_
+    uint32_t raw_next(uint32_t index) const {
+        const IndexLinks& node = map_.entry_at(index).value.links;
+        if (node.next != IndexList::npos) {
+            return node.next;
+        }
+        return node.tag == kProbation ? IndexList::npos : probation_.front();
+    }
+
+    uint32_t skip_stale(uint32_t index) const {
+        while (index != IndexList::npos && stale(index)) {
+            index = raw_next(index);
+        }
+        return index;
+    }
+
+    // Remove every entry for which doomed(position) is true, in one pass
+    template <typename Fn>
+    size_t remove_where(Fn&& doomed) {
+        size_t removed = map_.erase_if(
+            [&](const auto&, uint32_t index) {
+                if (!doomed(index)) {
+                    return false;
+                }
+                segment_of(index).remove(index, links());
+                return true;
+            },
+            [&](uint32_t from, uint32_t to) {
+                segment_of(to).relocate(from, to, links());
+                if (tagged_) {
+                    tags_[to] = tags_[from];
+                }
+            });
+        while (tags_.size() > map_.size()) {
+            tags_.pop_back();
+        }
+        ++version_;
+        return removed;
+    }
+
+    // Unlink and erase the entry at a table position
+    void remove_at(uint32_t index) {
+        segment_of(index).remove(index, links());
+        // The table fills the hole with its last entry; follow it
+        uint32_t moved = map_.erase_at(index);
+        if (moved != Map::npos) {
+            segment_of(index).relocate(moved, index, links());
+            if (tagged_) {
+                tags_[index] = tags_[moved];
+            }
+        }
+        if (tagged_) {
+            tags_.pop_back();
+        }
+        ++version_;
+    }
+
+    // Move the protected tail to the front of probation
+    void demote() {
+        uint32_t demoted = list_.back();
+        list_.remove(demoted, links());
+        map_.entry_at(demoted).value.links.tag = kProbation;
+        probation_.push_front(demoted, links());
+    }
+
+    // Feed a request to the hit ratio estimate, resizing when due
+    void observe(const Key& key) {
+        if (!curve_) return;
+        curve_->access(key);
+        if (auto_resize_ && --auto_resize_->countdown == 0) {
+            auto_resize_->countdown = auto_resize_->interval;
+            if (curve_->sampled() >= kMinSampledForResize) {
+                retune();
+            }
+        }
+    }
+
+    void retune() {
+        const AutoResize& bounds = *auto_resize_;
+        double target = curve_->hit_ratio(bounds.max_capacity) - bounds.tolerance;
+        size_t best = bounds.max_capacity;
+        for (size_t capacity = bounds.min_capacity; capacity < bounds.max_capacity; capacity += curve_->bin_width()) {
+            if (curve_->hit_ratio(capacity) >= target) {
+                best = capacity;
+                break;
+            }
+        }
+        set_capacity(best);
+        curve_->age();
+    }
+
+    void touch(uint32_t index) {
+        ++version_;
+        IndexLinks& node = map_.entry_at(index).value.links;
+        if (node.tag == kProbation) {
+            // Promote, demoting the protected tail if the segment overflows
+            probation_.remove(index, links());
+            node.tag = kProtected;
+            list_.push_front(index, links());
+            if (list_.size() > protected_capacity_) {
+                demote();
+            }
+        }
+        else {
+            list_.move_to_front(index, links()); // No need to update map_, positions are unchanged
+        }
+        if (map_.rehashing()) {
+            map_.rehash_step(); // Hits drive a pending rehash too, not just inserts
+        }
+    }
+
+    // Grow storage geometrically, but never past capacity_, so that a full
+    // cache carries no slack
+    void grow() {
+        if (map_.size() == map_.entry_capacity()) {
+            size_t target = map_.size() < 8 ? 8 : map_.size() * 2;
+            target = target < capacity_ ? target : capacity_;
+            TraceScope<Trace> scope(TraceEvent::Grow, target);
+            map_.reserve(target);
+            if (tagged_) {
+                tags_.reserve(target);
+            }
+        }
+    }
+
+
     void evict() {
-        // Remove the least recently used element (tail)
-        if (list_.empty()) return;
-        Key lru_key = list_.back().key;
-        list_.pop_back();
-        map_.erase(lru_key);
+        // Remove the least recently used element (tail), probation first
+        IndexList& victims = probation_.empty() ? list_ : probation_;
+        if (victims.empty()) return;
+        TraceScope<Trace> scope(TraceEvent::Evict);
+        uint32_t victim = victims.back();
+        if (on_evict_ && !stale(victim)) {
+            auto& entry = map_.entry_at(victim);
+            on_evict_(entry.key, entry.value.value);
+        }
+        remove_at(victim);
+    }
+};
+
+// Forward iterator in MRU -> LRU order. Dereferencing yields an Item
+// referring to the entry in place.
+template <typename Key, typename Value, typename Alloc, typename Trace>
+template <bool Const>
+class LRUCache<Key, Value, Alloc, Trace>::BasicIterator {
+    using Cache = std::conditional_t<Const, const LRUCache, LRUCache>;
+
+public:
+    using iterator_concept = std::forward_iterator_tag;
+    using iterator_category = std::input_iterator_tag; // operator* returns a proxy
+    using value_type = Item<Const>;
+    using difference_type = std::ptrdiff_t;
+    using reference = Item<Const>;
+
+    BasicIterator() : cache_(nullptr), index_(IndexList::npos), version_(0) {}
+
+    // iterator converts to const_iterator
+    template <bool C = Const, typename = std::enable_if_t<C>>
+    BasicIterator(const BasicIterator<false>& other)
+        : cache_(other.cache_), index_(other.index_), version_(other.version_) {
+    }
+
+    reference operator*() const {
+        assert(cache_->version_ == version_ && "LRUCache iterator used after the cache changed");
+        auto& entry = cache_->map_.entry_at(index_);
+        return reference{ entry.key, entry.value.value };
+    }
+
+    BasicIterator& operator++() {
+        assert(cache_->version_ == version_ && "LRUCache iterator used after the cache changed");
+        index_ = cache_->next(index_);
+        return *this;
+    }
+
+    BasicIterator operator++(int) {
+        BasicIterator previous = *this;
+        ++*this;
+        return previous;
+    }
+
+    friend bool operator==(const BasicIterator& a, const BasicIterator& b) {
+        return a.index_ == b.index_;
+    }
+
+    friend bool operator!=(const BasicIterator& a, const BasicIterator& b) {
+        return a.index_ != b.index_;
+    }
+
+private:
+    friend class LRUCache;
+    template <bool>
+    friend class BasicIterator;
+
+    BasicIterator(Cache* cache, uint32_t index)
+        : cache_(cache), index_(index), version_(cache->version_) {
     }
+
+    Cache* cache_;
+    uint32_t index_;
+    uint64_t version_;
 };
@@ -0,0 +1,64 @@
+// lru_debug.hpp
+
+#pragma once
+
+#ifndef LRU_DEBUG_HPP
+#define LRU_DEBUG_HPP
+
+#include <iostream>
+#include <string_view>
+#include "lru.hpp"
+
+#if LRUCACHE_DEBUG_API
+
+// Dump sink that writes "k: v -> " for each entry, of every section or of
+// only the one named `only`, with "NULL\n" closing each section written
+struct StreamDumpSink {
+    std::ostream& out;
+    const char* only = nullptr;
+    bool headers = false;
+    bool writing = false;
+
+    void section(const char* name) {
+        if (writing) {
+            out << "NULL\n";
+        }
+        writing = only == nullptr || std::string_view(name) == only;
+        if (writing && headers) {
+            out << name << ": ";
+        }
+    }
+
+    template <typename Key, typename Value>
+    void operator()(const Key& key, const Value& value) {
+        if (writing) {
+            out << key << ": " << value << " -> ";
+        }
+    }
+
+    void finish() {
+        if (writing) {
+            out << "NULL\n";
+        }
+    }
+};
+
+// Prints "k: v -> ... NULL", MRU -> LRU
+template <typename Cache>
+void display(const Cache& cache, std::ostream& out = std::cout) {
+    StreamDumpSink sink{ out, "List" };
+    cache.dump(sink);
+    sink.finish();
+}
+
+// Prints "List: k: v -> ... NULL" and "Map: k: v -> ... NULL"
+template <typename Cache>
+void print_state(const Cache& cache, std::ostream& out = std::cout) {
+    StreamDumpSink sink{ out, nullptr, true };
+    cache.dump(sink);
+    sink.finish();
+}
+
+#endif // LRUCACHE_DEBUG_API
+
+#endif // LRU_DEBUG_HPP
@@ -0,0 +1,267 @@
+// memory_pressure.hpp
+
+#pragma once
+
+#ifndef MEMORY_PRESSURE_HPP
+#define MEMORY_PRESSURE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// A cache bounded by entry count cannot see the memory around it: when
+// other allocations in the process or container spike, the kernel OOM
+// killer takes the whole process. MemoryPressureMonitor watches memory
+// usage and stall time, and asks a handler to shed memory, typically
+// through LRUCache::release_memory(), before that happens.
+
+// One reading of memory state
+struct MemoryPressure {
+    size_t used = 0;    // Bytes in use (charged to the cgroup, or system-wide)
+    size_t limit = 0;   // Bytes usable in total; 0 if unknown
+    double stall = 0.0; // Share of the last 10 s in which some task stalled
+                        // waiting for memory (PSI "some avg10"), in [0, 1]
+
+    double usage() const {
+        return limit == 0 ? 0.0 : static_cast<double>(used) / static_cast<double>(limit);
+    }
+};
+
+// Reads memory state from Linux: the cgroup v2 files memory.current,
+// memory.max and memory.pressure under `cgroup_dir`, and where there is no
+// cgroup (or no limit on it) /proc/meminfo and /proc/pressure/memory under
+// `proc_dir`. Missing files read as zero, so on other systems every reading
+// is empty and never counts as pressure.
+class SystemMemorySource {
+public:
+    explicit SystemMemorySource(std::string cgroup_dir = "/sys/fs/cgroup", std::string proc_dir = "/proc")
+        : cgroup_dir_(std::move(cgroup_dir)), proc_dir_(std::move(proc_dir)) {}
+
+    MemoryPressure operator()() const {
+        MemoryPressure reading;
+        size_t total = 0;
+        size_t available = 0;
+        bool have_cgroup = read_number(cgroup_dir_ + "/memory.current", reading.used);
+        if (have_cgroup) {
+            reading.stall = read_stall(cgroup_dir_ + "/memory.pressure");
+            if (!read_number(cgroup_dir_ + "/memory.max", reading.limit)) {
+                // "max": no cgroup limit, so the machine's memory is the limit
+                read_meminfo(total, available);
+                reading.limit = total;
+            }
+        }
+        else {
+            read_meminfo(total, available);
+            reading.used = total > available ? total - available : 0;
+            reading.limit = total;
+            reading.stall = read_stall(proc_dir_ + "/pressure/memory");
+        }
+        return reading;
+    }
+
+private:
+    std::string cgroup_dir_;
+    std::string proc_dir_;
+
+    // False if the file is missing or does not start with a number
+    static bool read_number(const std::string& path, size_t& value) {
+        std::ifstream in(path);
+        unsigned long long number = 0;
+        if (!(in >> number)) {
+            return false;
+        }
+        value = static_cast<size_t>(number);
+        return true;
+    }
+
+    // "some avg10=1.25 avg60=... total=..." on the first line
+    static double read_stall(const std::string& path) {
+        std::ifstream in(path);
+        std::string kind;
+        std::string field;
+        if (!(in >> kind >> field) || kind != "some" || field.rfind("avg10=", 0) != 0) {
+            return 0.0;
+        }
+        try {
+            return std::stod(field.substr(6)) / 100.0;
+        }
+        catch (const std::exception&) {
+            return 0.0;
+        }
+    }
+
+    // MemTotal and MemAvailable, in bytes
+    void read_meminfo(size_t& total, size_t& available) const {
+        std::ifstream in(proc_dir_ + "/meminfo");
+        std::string name;
+        unsigned long long kb = 0;
+        std::string unit;
+        while (in >> name >> kb >> unit) {
+            if (name == "MemTotal:") {
+                total = static_cast<size_t>(kb) * 1024;
+            }
+            else if (name == "MemAvailable:") {
+                available = static_cast<size_t>(kb) * 1024;
+            }
+        }
+    }
+};
+
+// Return memory freed back to the allocator on to the OS where the
+// allocator keeps it (glibc's heap); a no-op elsewhere
+inline void release_free_heap() {
+#if defined(__GLIBC__)
+    ::malloc_trim(0);
+#endif
+}
+
+// Polls a source of MemoryPressure readings, by default SystemMemorySource,
+// and calls on_pressure(excess_bytes, reading) when memory is tight:
+//   - usage above `high`: excess is what it takes to get back to `low`,
+//     asked again on every poll until usage is back under `high`,
+//   - otherwise stall at or above `stall`: excess is 0, and the handler
+//     should shed a share of its own memory (shed_from() sheds
+//     `stall_share` of the cache). PSI averages over 10 s, so a stall
+//     reading lingers long after the stall: it triggers once when it
+//     crosses `stall`, and again only each time it climbs another `stall`
+//     above the reading that last triggered.
+// Tests pass a fake source instead of the system one.
+//
+// poll() checks once on the calling thread; start() polls on a background
+// thread until stop() or destruction, and the handler then runs on that
+// thread, so it must lock whatever it touches (see shed_from()). Do not
+// call poll() while the background thread runs.
+class MemoryPressureMonitor {
+public:
+    using Source = std::function<MemoryPressure()>;
+    using Handler = std::function<void(size_t excess_bytes, const MemoryPressure& reading)>;
+
+    MemoryPressureMonitor(Handler on_pressure, Source source = SystemMemorySource(),
+                          double high = 0.9, double low = 0.8, double stall = 0.1)
+        : on_pressure_(std::move(on_pressure)), source_(std::move(source)), high_(high), low_(low),
+          stall_(stall), next_stall_(stall), triggers_(0), running_(false) {
+        if (!(low > 0 && low <= high && high <= 1)) {
+            throw std::invalid_argument("MemoryPressureMonitor needs 0 < low <= high <= 1");
+        }
+    }
+
+    ~MemoryPressureMonitor() { stop(); }
+
+    MemoryPressureMonitor(const MemoryPressureMonitor&) = delete;
+    MemoryPressureMonitor& operator=(const MemoryPressureMonitor&) = delete;
+
+    // Read once and call the handler if under pressure. Returns true if
+    // it was called.
+    bool poll();
+
+    void start(std::chrono::milliseconds interval = std::chrono::milliseconds(250));
+    void stop();
+    bool running() const { return running_; }
+
+    // Times the handler has been called
+    uint64_t triggers() const { return triggers_.load(std::memory_order_relaxed); }
+
+private:
+    Handler on_pressure_;
+    Source source_;
+    double high_;
+    double low_;
+    double stall_;
+    double next_stall_; // Stall reading that triggers next
+    std::atomic<uint64_t> triggers_;
+
+    bool running_;
+    bool stopping_ = false;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::thread thread_;
+};
+
+// Poll method
+inline bool MemoryPressureMonitor::poll() {
+    MemoryPressure reading = source_();
+    if (reading.limit == 0) {
+        return false;
+    }
+    if (reading.stall < stall_) {
+        next_stall_ = stall_; // The stall has passed; re-arm
+    }
+    size_t excess = 0;
+    if (reading.usage() > high_) {
+        excess = reading.used - static_cast<size_t>(static_cast<double>(reading.limit) * low_);
+    }
+    else if (reading.stall >= next_stall_) {
+        next_stall_ = reading.stall + stall_;
+    }
+    else {
+        return false;
+    }
+    triggers_.fetch_add(1, std::memory_order_relaxed);
+    on_pressure_(excess, reading);
+    return true;
+}
+
+// Start method
+inline void MemoryPressureMonitor::start(std::chrono::milliseconds interval) {
+    if (running_) {
+        throw std::logic_error("MemoryPressureMonitor is already running");
+    }
+    stopping_ = false;
+    running_ = true;
+    thread_ = std::thread([this, interval] {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopping_) {
+            lock.unlock();
+            poll();
+            lock.lock();
+            wake_.wait_for(lock, interval, [this] { return stopping_; });
+        }
+    });
+}
+
+// Stop method
+inline void MemoryPressureMonitor::stop() {
+    if (!running_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+    running_ = false;
+}
+
+// Handler that sheds the excess from `cache`, or `stall_share` of the
+// cache's memory when asked for no excess (a stall), holding `mutex` (the
+// lock that guards every other use of the cache) while it evicts, then
+// returns the freed heap to the OS
+template <typename Cache>
+MemoryPressureMonitor::Handler shed_from(Cache& cache, std::mutex& mutex, double stall_share = 0.1) {
+    return [&cache, &mutex, stall_share](size_t excess, const MemoryPressure&) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (excess == 0) {
+                excess = static_cast<size_t>(static_cast<double>(cache.memory_usage()) * stall_share);
+            }
+            cache.release_memory(excess);
+        }
+        release_free_heap();
+    };
+}
+
+#endif // MEMORY_PRESSURE_HPP
@@ -0,0 +1,217 @@
+// mrc.hpp
+
+#pragma once
+
+#ifndef MRC_HPP
+#define MRC_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "hashtable.hpp"
+
+// Online estimate of an LRU cache's miss ratio curve, the hit ratio it would
+// get at every capacity up to `max_capacity`, from one pass over the request
+// stream (SHARDS, Waldspurger et al., FAST '15).
+//
+// Only keys whose hash falls below a threshold are tracked, a fixed fraction
+// `sample_rate` of the key space, so memory is proportional to the number of
+// distinct keys times that rate. For each sampled request the estimator
+// computes its stack distance among sampled keys, the number of distinct
+// sampled keys requested since the previous request for the same key, with
+// a Fenwick tree over request times; dividing by the rate scales it to the
+// full stream. A request would hit in an LRU cache of capacity c iff its
+// scaled distance is below c, so a histogram of distances is the curve.
+//
+// With the SHARDS-adj correction for skew in the sample, a few thousand
+// sampled keys typically put the curve within a few percent of the exact
+// one. age() halves the weight of history so that the curve follows a
+// changing workload.
+template <typename Key>
+class MissRatioCurve {
+public:
+    MissRatioCurve(size_t max_capacity, double sample_rate = 0.01, size_t bins = 256)
+        : rate_(sample_rate), histogram_(bins + 1, 0.0), total_(0), requests_(0), now_(0), sampled_(0) {
+        if (!(sample_rate > 0 && sample_rate <= 1)) {
+            throw std::invalid_argument("MissRatioCurve sample rate must be in (0, 1]");
+        }
+        if (max_capacity == 0 || bins == 0) {
+            throw std::invalid_argument("MissRatioCurve needs a positive capacity and bin count");
+        }
+        threshold_ = static_cast<uint64_t>(sample_rate * static_cast<double>(kHashSpace));
+        bin_width_ = (max_capacity + bins - 1) / bins;
+        tree_.assign(kMinTimes + 1, 0);
+    }
+
+    // Record a request for `key`
+    void access(const Key& key);
+
+    // Estimated hit ratio of an LRU cache with `capacity` entries over the
+    // requests seen so far; 0 before any request has been sampled
+    double hit_ratio(size_t capacity) const;
+    double miss_ratio(size_t capacity) const { return 1.0 - hit_ratio(capacity); }
+
+    // Largest capacity the curve resolves, and its resolution
+    size_t max_capacity() const { return bin_width_ * (histogram_.size() - 1); }
+    size_t bin_width() const { return bin_width_; }
+
+    // Requests that were sampled, and distinct keys among them
+    uint64_t sampled() const { return sampled_; }
+    size_t sampled_keys() const { return last_access_.size(); }
+
+    // Halve the weight of everything recorded so far
+    void age() {
+        for (double& count : histogram_) {
+            count /= 2;
+        }
+        total_ /= 2;
+        requests_ /= 2;
+    }
+
+    void clear() {
+        std::fill(histogram_.begin(), histogram_.end(), 0.0);
+        total_ = 0;
+        requests_ = 0;
+        last_access_.clear();
+        tree_.assign(kMinTimes + 1, 0);
+        now_ = 0;
+        sampled_ = 0;
+    }
+
+    // Heap bytes held by the estimator
+    size_t memory_usage() const {
+        return last_access_.memory_usage() + tree_.capacity() * sizeof(uint32_t) +
+               histogram_.capacity() * sizeof(double);
+    }
+
+private:
+    static constexpr uint64_t kHashSpace = uint64_t(1) << 24;
+    static constexpr size_t kMinTimes = 1024;
+
+    double rate_;
+    uint64_t threshold_;          // Sample keys whose hash is below this
+    size_t bin_width_;
+    std::vector<double> histogram_; // Requests per distance bin; the last bin
+                                    // holds first requests and distances
+                                    // beyond max_capacity()
+    double total_;     // Sampled requests recorded
+    double requests_;  // All requests seen, sampled or not
+    HashTable<Key, uint64_t> last_access_; // Sampled key -> time of its last request
+    std::vector<uint32_t> tree_;  // Fenwick tree over times 1..size-1: 1 at
+                                  // each key's last request time
+    uint64_t now_;
+    uint64_t sampled_;
+
+    // Top 24 bits of a mixed hash; the table's own slots and fingerprints
+    // come from the low bits, so sampled keys still spread over it
+    static uint64_t sample_hash(const Key& key) {
+        uint64_t h = static_cast<uint64_t>(std::hash<Key>{}(key)) * 0xD6E8FEB86659FD93ULL;
+        h ^= h >> 32;
+        return (h * 0x9E3779B97F4A7C15ULL) >> 40;
+    }
+
+    size_t times() const { return tree_.size() - 1; }
+
+    void mark(uint64_t time, int delta) {
+        for (size_t i = static_cast<size_t>(time); i < tree_.size(); i += i & (~i + 1)) {
+            tree_[i] = static_cast<uint32_t>(static_cast<int64_t>(tree_[i]) + delta);
+        }
+    }
+
+    uint64_t marked_up_to(uint64_t time) const {
+        uint64_t sum = 0;
+        for (size_t i = static_cast<size_t>(time); i > 0; i -= i & (~i + 1)) {
+            sum += tree_[i];
+        }
+        return sum;
+    }
+
+    void record(double distance) {
+        size_t bin = static_cast<size_t>(distance / static_cast<double>(bin_width_));
+        histogram_[std::min(bin, histogram_.size() - 1)] += 1;
+        total_ += 1;
+    }
+
+    void compact();
+};
+
+// Access method
+template <typename Key>
+void MissRatioCurve<Key>::access(const Key& key) {
+    requests_ += 1;
+    if (sample_hash(key) >= threshold_) {
+        return;
+    }
+    ++sampled_;
+    if (now_ == times()) {
+        compact();
+    }
+    uint64_t time = ++now_;
+    uint64_t* last = last_access_.find(key);
+    if (last) {
+        uint64_t distance = marked_up_to(time - 1) - marked_up_to(*last);
+        mark(*last, -1);
+        *last = time;
+        record(static_cast<double>(distance) / rate_);
+    }
+    else {
+        last_access_.insert(key, time);
+        record(static_cast<double>(max_capacity())); // A first request misses at any size
+    }
+    mark(time, +1);
+}
+
+// Hit ratio method
+template <typename Key>
+double MissRatioCurve<Key>::hit_ratio(size_t capacity) const {
+    if (total_ == 0 || capacity == 0) {
+        return 0.0;
+    }
+    // SHARDS-adj: a few hot keys in or out of the sample skew the number
+    // of sampled requests away from rate * requests. The difference is
+    // mostly repeat requests for those keys, so it is credited to (or taken
+    // from) the smallest distances.
+    double expected = requests_ * rate_;
+    double hits = expected - total_;
+    double width = static_cast<double>(bin_width_);
+    for (size_t bin = 0; bin + 1 < histogram_.size(); ++bin) {
+        double start = static_cast<double>(bin) * width;
+        if (start >= static_cast<double>(capacity)) break;
+        // Distances are taken as spread evenly over a bin
+        double covered = std::min(1.0, (static_cast<double>(capacity) - start) / width);
+        hits += histogram_[bin] * covered;
+    }
+    return std::max(0.0, std::min(1.0, hits / expected));
+}
+
+// Renumber request times 1..n in order once the tree is full, so that it
+// only ever spans the keys' last requests. Sizing it to twice the key count
+// keeps the sort amortised to O(log n) per request.
+template <typename Key>
+void MissRatioCurve<Key>::compact() {
+    std::vector<std::pair<uint64_t, uint32_t>> order; // (time, table position)
+    order.reserve(last_access_.size());
+    for (uint32_t i = 0; i < last_access_.size(); ++i) {
+        order.emplace_back(last_access_.entry_at(i).value, i);
+    }
+    std::sort(order.begin(), order.end());
+    size_t size = std::max(kMinTimes, order.size() * 2);
+    tree_.assign(size + 1, 0);
+    for (size_t t = 1; t <= order.size(); ++t) {
+        last_access_.entry_at(order[t - 1].second).value = t;
+        tree_[t] = 1;
+    }
+    // Build the Fenwick tree over the marks in place
+    for (size_t i = 1; i <= size; ++i) {
+        size_t parent = i + (i & (~i + 1));
+        if (parent <= size) {
+            tree_[parent] += tree_[i];
+        }
+    }
+    now_ = order.size();
+}
+
+#endif // MRC_HPP
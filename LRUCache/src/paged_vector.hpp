@@ -0,0 +1,167 @@
+// paged_vector.hpp
+
+#pragma once
+
+#ifndef PAGED_VECTOR_HPP
+#define PAGED_VECTOR_HPP
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+#include "allocator.hpp"
+
+// Vector-like sequence stored in fixed-size pages that never move once they
+// are full, so growing it never copies more than one page's worth of
+// elements and references stay valid across push_back (past the first page).
+//
+// The first page starts small and doubles up to kPageSize, so small
+// containers do not pay for a whole page. Only the page table (one pointer
+// per page) is reallocated as the container grows. Pages come from `Alloc`
+// (see allocator.hpp) and fill one of its blocks when it has a block size.
+template <typename T, typename Alloc = DefaultAllocator>
+class PagedVector {
+public:
+    static constexpr size_t kPageSize =
+        Alloc::block_size / sizeof(T) > 4096 ? Alloc::block_size / sizeof(T) : 4096;
+
+    explicit PagedVector(const Alloc& alloc = Alloc()) : alloc_(alloc), size_(0), first_page_capacity_(0) {}
+
+    PagedVector(PagedVector&& other) noexcept
+        : alloc_(other.alloc_), pages_(std::move(other.pages_)), size_(other.size_), first_page_capacity_(other.first_page_capacity_) {
+        other.pages_.clear();
+        other.size_ = 0;
+        other.first_page_capacity_ = 0;
+    }
+
+    PagedVector(const PagedVector&) = delete;
+    PagedVector& operator=(const PagedVector&) = delete;
+
+    ~PagedVector() {
+        clear();
+        release_pages(0);
+    }
+
+    T& operator[](size_t index) { return pages_[index / kPageSize][index % kPageSize]; }
+    const T& operator[](size_t index) const { return pages_[index / kPageSize][index % kPageSize]; }
+
+    T& back() { return (*this)[size_ - 1]; }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    size_t capacity() const {
+        return pages_.size() <= 1 ? first_page_capacity_ : pages_.size() * kPageSize;
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (size_ == capacity()) {
+            grow(size_ + 1);
+        }
+        T* slot = &(*this)[size_];
+        ::new (static_cast<void*>(slot)) T(std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    void pop_back() {
+        --size_;
+        (*this)[size_].~T();
+    }
+
+    // Destroys the elements but keeps the pages
+    void clear() {
+        while (size_ > 0) {
+            pop_back();
+        }
+    }
+
+    void reserve(size_t count) {
+        if (count > capacity()) {
+            grow(count);
+        }
+    }
+
+    // Free the pages past the last element, and fit a partly used first
+    // page to the elements it holds when that is the only page
+    void shrink_to_fit() {
+        release_pages((size_ + kPageSize - 1) / kPageSize);
+        if (pages_.size() == 1 && size_ < first_page_capacity_) {
+            resize_first_page(size_);
+        }
+        pages_.shrink_to_fit();
+    }
+
+    // Heap bytes held by pages and the page table
+    size_t memory_usage() const {
+        return capacity() * sizeof(T) + pages_.capacity() * sizeof(T*);
+    }
+
+private:
+    T* allocate(size_t count) {
+        return static_cast<T*>(alloc_.allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* page, size_t count) {
+        alloc_.deallocate(page, count * sizeof(T), alignof(T));
+    }
+
+    size_t page_capacity(size_t page) const {
+        return page == 0 ? first_page_capacity_ : kPageSize;
+    }
+
+    // Make room for at least `count` elements
+    void grow(size_t count) {
+        if (pages_.size() <= 1 && first_page_capacity_ < kPageSize) {
+            // Still inside the first page: double it (or fit `count` exactly
+            // when reserving), which moves at most kPageSize elements
+            size_t target = first_page_capacity_ == 0 ? 8 : first_page_capacity_ * 2;
+            if (count > size_ + 1 || target < count) {
+                target = count;
+            }
+            resize_first_page(target < kPageSize ? target : kPageSize);
+        }
+        while (capacity() < count) {
+            pages_.push_back(allocate(kPageSize));
+        }
+    }
+
+    void resize_first_page(size_t new_capacity) {
+        T* page = allocate(new_capacity);
+        if (!pages_.empty()) {
+            T* old = pages_[0];
+            for (size_t i = 0; i < size_; ++i) {
+                ::new (static_cast<void*>(page + i)) T(std::move(old[i]));
+                old[i].~T();
+            }
+            deallocate(old, first_page_capacity_);
+            pages_[0] = page;
+        }
+        else {
+            pages_.push_back(page);
+        }
+        first_page_capacity_ = new_capacity;
+    }
+
+    // Free pages from `first` on; they must hold no elements
+    void release_pages(size_t first) {
+        for (size_t page = pages_.size(); page > first; --page) {
+            deallocate(pages_[page - 1], page_capacity(page - 1));
+            pages_.pop_back();
+        }
+        if (pages_.empty()) {
+            first_page_capacity_ = 0;
+        }
+    }
+
+    Alloc alloc_;
+    std::vector<T*> pages_;
+    size_t size_;
+    size_t first_page_capacity_;
+};
+
+#endif // PAGED_VECTOR_HPP
@@ -0,0 +1,371 @@
+// pipelined_lru.hpp
+
+#pragma once
+
+#ifndef PIPELINED_LRU_HPP
+#define PIPELINED_LRU_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "lru.hpp"
+#include "spsc_queue.hpp"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Shared-nothing LRU cache: the key space is split across shards, and each
+// shard is a private LRUCache owned by one thread, optionally pinned to a
+// core. No other thread ever touches a shard's table or recency list, so
+// they need no lock and their cache lines never bounce between cores.
+//
+// Threads reach the shards through a Client from connect(). Each client
+// has an SPSC queue of requests to every shard and one of responses back,
+// so a queue only ever has one writer and one reader. Owners poll their
+// queues and take up to kBatchSize requests at a time; they prefetch the
+// table lines of the whole batch before serving it, so the batch's cache
+// misses overlap instead of running back to back.
+//
+// Requests from one client to one shard are served in order: a get after
+// a put of the same key sees it. put() and erase() return once queued;
+// get() waits for its answer, and get_many() sends every lookup before
+// waiting for any. Owners busy-poll while there is traffic and nap briefly
+// once idle, so the first request after a lull may wait up to kIdleNap.
+//
+// Key and Value must be default constructible (queue slots hold them).
+// Every Client must be destroyed before the cache.
+template <typename Key, typename Value>
+class PipelinedLRUCache {
+    enum class Op : uint8_t { Get, Put, Erase };
+
+    struct Request {
+        Op op = Op::Get;
+        uint32_t ticket = 0; // Position in the caller's batch, for gets
+        Key key{};
+        Value value{};
+    };
+
+    struct Response {
+        uint32_t ticket = 0;
+        bool found = false;
+        Value value{};
+    };
+
+public:
+    static constexpr size_t kQueueDepth = 256; // Requests in flight per client and shard
+    static constexpr size_t kBatchSize = 32;   // Requests an owner takes from a queue at once
+    static constexpr std::chrono::microseconds kIdleNap{ 50 };
+
+    class Client;
+
+    // `capacity` entries in total, split as evenly as possible across
+    // `shards` owner threads. With `pin_threads`, owner i runs on CPU i (modulo the CPU
+    // count) where the platform allows it.
+    PipelinedLRUCache(size_t shards, size_t capacity, size_t max_clients = 16, bool pin_threads = false);
+    ~PipelinedLRUCache();
+
+    PipelinedLRUCache(const PipelinedLRUCache&) = delete;
+    PipelinedLRUCache& operator=(const PipelinedLRUCache&) = delete;
+
+    // A handle for the calling thread; throws if max_clients are connected
+    Client connect();
+
+    size_t shards() const { return shards_.size(); }
+    size_t shard_of(const Key& key) const {
+        uint64_t h = static_cast<uint64_t>(std::hash<Key>{}(key)) * 0xD6E8FEB86659FD93ULL;
+        return static_cast<size_t>((h >> 32) % shards_.size());
+    }
+
+    // Entries across all shards, as each owner last published: after every
+    // batch and before every answer to a get
+    size_t size() const;
+
+private:
+    static constexpr size_t kSpinRounds = 1024; // Empty polls before an owner starts napping
+
+    struct Channel {
+        SpscQueue<Request> requests{ kQueueDepth };
+        SpscQueue<Response> responses{ kQueueDepth };
+    };
+
+    struct ClientSlot {
+        std::atomic<bool> taken{ false };
+        std::atomic<bool> ready{ false }; // Channels allocated; never reset
+        std::unique_ptr<Channel[]> channels; // One per shard
+    };
+
+    struct alignas(64) Shard {
+        explicit Shard(size_t capacity) : cache(capacity) {}
+
+        LRUCache<Key, Value> cache; // Touched only by the owner thread
+        std::atomic<size_t> size{ 0 };
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::unique_ptr<ClientSlot[]> clients_;
+    size_t max_clients_;
+    bool pin_threads_;
+    std::atomic<bool> stopping_{ false };
+
+    void run(size_t index);
+    size_t serve(Shard& shard, Channel& channel, std::vector<Request>& batch);
+    static void pin(size_t cpu);
+};
+
+// A thread's connection to the shards. Movable, not shareable: use one per
+// thread. Destroying it frees its slot for another connect().
+template <typename Key, typename Value>
+class PipelinedLRUCache<Key, Value>::Client {
+public:
+    Client(Client&& other) noexcept
+        : cache_(other.cache_), slot_(other.slot_), outstanding_(std::move(other.outstanding_)) {
+        other.cache_ = nullptr;
+    }
+
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+    Client& operator=(Client&&) = delete;
+
+    ~Client() {
+        if (cache_) {
+            cache_->clients_[slot_].taken.store(false, std::memory_order_release);
+        }
+    }
+
+    void put(const Key& key, const Value& value) {
+        send(Request{ Op::Put, 0, key, value }, nullptr);
+    }
+
+    void erase(const Key& key) {
+        send(Request{ Op::Erase, 0, key, Value{} }, nullptr);
+    }
+
+    std::optional<Value> get(const Key& key) {
+        std::vector<std::optional<Value>> results(1);
+        send(Request{ Op::Get, 0, key, Value{} }, &results);
+        wait(results);
+        return std::move(results[0]);
+    }
+
+    // Look up every key, sending them all before waiting for any answer.
+    // Result i is the value of keys[i], or nullopt on a miss.
+    std::vector<std::optional<Value>> get_many(const std::vector<Key>& keys) {
+        std::vector<std::optional<Value>> results(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            send(Request{ Op::Get, static_cast<uint32_t>(i), keys[i], Value{} }, &results);
+        }
+        wait(results);
+        return results;
+    }
+
+private:
+    friend class PipelinedLRUCache;
+
+    Client(PipelinedLRUCache* cache, size_t slot)
+        : cache_(cache), slot_(slot), outstanding_(cache->shards(), 0) {}
+
+    PipelinedLRUCache* cache_;
+    size_t slot_;
+    std::vector<size_t> outstanding_; // Gets awaiting an answer, per shard
+
+    Channel& channel(size_t shard) { return cache_->clients_[slot_].channels[shard]; }
+
+    // Queue a request, collecting answers while its queue is full. Gets
+    // in flight to a shard never exceed its response queue, so an owner
+    // can always answer without waiting on this thread.
+    void send(Request&& request, std::vector<std::optional<Value>>* results) {
+        size_t shard = cache_->shard_of(request.key);
+        bool is_get = request.op == Op::Get;
+        while ((is_get && outstanding_[shard] == kQueueDepth) || !channel(shard).requests.try_push(std::move(request))) {
+            if (results) {
+                collect(*results);
+            }
+            std::this_thread::yield();
+        }
+        if (is_get) {
+            ++outstanding_[shard];
+        }
+    }
+
+    void collect(std::vector<std::optional<Value>>& results) {
+        Response response;
+        for (size_t shard = 0; shard < outstanding_.size(); ++shard) {
+            while (outstanding_[shard] > 0 && channel(shard).responses.try_pop(response)) {
+                if (response.found) {
+                    results[response.ticket] = std::move(response.value);
+                }
+                --outstanding_[shard];
+            }
+        }
+    }
+
+    void wait(std::vector<std::optional<Value>>& results) {
+        for (;;) {
+            collect(results);
+            size_t pending = 0;
+            for (size_t count : outstanding_) {
+                pending += count;
+            }
+            if (pending == 0) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+};
+
+// Constructor
+template <typename Key, typename Value>
+PipelinedLRUCache<Key, Value>::PipelinedLRUCache(size_t shards, size_t capacity, size_t max_clients, bool pin_threads)
+    : max_clients_(max_clients), pin_threads_(pin_threads) {
+    if (shards == 0 || max_clients == 0) {
+        throw std::invalid_argument("PipelinedLRUCache needs at least one shard and one client");
+    }
+    clients_.reset(new ClientSlot[max_clients]);
+    // The first capacity % shards shards take one entry more than the rest
+    for (size_t i = 0; i < shards; ++i) {
+        shards_.push_back(std::make_unique<Shard>(capacity / shards + (i < capacity % shards ? 1 : 0)));
+    }
+    for (size_t i = 0; i < shards; ++i) {
+        shards_[i]->thread = std::thread([this, i] { run(i); });
+    }
+}
+
+// Destructor: owners finish what is queued, then exit
+template <typename Key, typename Value>
+PipelinedLRUCache<Key, Value>::~PipelinedLRUCache() {
+    stopping_.store(true, std::memory_order_release);
+    for (auto& shard : shards_) {
+        shard->thread.join();
+    }
+}
+
+// Connect method
+template <typename Key, typename Value>
+typename PipelinedLRUCache<Key, Value>::Client PipelinedLRUCache<Key, Value>::connect() {
+    for (size_t slot = 0; slot < max_clients_; ++slot) {
+        ClientSlot& client = clients_[slot];
+        bool expected = false;
+        if (!client.taken.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            continue;
+        }
+        if (!client.ready.load(std::memory_order_relaxed)) {
+            client.channels.reset(new Channel[shards_.size()]);
+            client.ready.store(true, std::memory_order_release); // Owners may poll it from now on
+        }
+        return Client(this, slot);
+    }
+    throw std::runtime_error("PipelinedLRUCache has no free client slot");
+}
+
+// Size method
+template <typename Key, typename Value>
+size_t PipelinedLRUCache<Key, Value>::size() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->size.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+// Owner loop: poll every client's queue for this shard until stopped and
+// drained
+template <typename Key, typename Value>
+void PipelinedLRUCache<Key, Value>::run(size_t index) {
+    if (pin_threads_) {
+        pin(index);
+    }
+    Shard& shard = *shards_[index];
+    std::vector<Request> batch(kBatchSize);
+    size_t idle = 0;
+    for (;;) {
+        bool stopping = stopping_.load(std::memory_order_acquire);
+        size_t handled = 0;
+        for (size_t slot = 0; slot < max_clients_; ++slot) {
+            if (clients_[slot].ready.load(std::memory_order_acquire)) {
+                handled += serve(shard, clients_[slot].channels[index], batch);
+            }
+        }
+        if (handled > 0) {
+            shard.size.store(shard.cache.size(), std::memory_order_relaxed);
+            idle = 0;
+            continue;
+        }
+        if (stopping) {
+            return; // A full pass after the stop found nothing left
+        }
+        if (++idle > kSpinRounds) {
+            std::this_thread::sleep_for(kIdleNap);
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// Serve up to kBatchSize requests from one queue. Returns the number served.
+template <typename Key, typename Value>
+size_t PipelinedLRUCache<Key, Value>::serve(Shard& shard, Channel& channel, std::vector<Request>& batch) {
+    size_t count = 0;
+    while (count < kBatchSize && channel.requests.try_pop(batch[count])) {
+        ++count;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        shard.cache.prefetch(batch[i].key);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        Request& request = batch[i];
+        switch (request.op) {
+        case Op::Get: {
+            Response response;
+            response.ticket = request.ticket;
+            if (Value* value = shard.cache.find(request.key)) {
+                response.found = true;
+                response.value = *value;
+            }
+            // Publish the size first, so that it is current for a client
+            // that has its answer; the client keeps its gets within the
+            // queue's depth, so there is room
+            shard.size.store(shard.cache.size(), std::memory_order_relaxed);
+            while (!channel.responses.try_push(std::move(response))) {
+                std::this_thread::yield();
+            }
+            break;
+        }
+        case Op::Put:
+            shard.cache.put(request.key, request.value);
+            break;
+        case Op::Erase:
+            shard.cache.erase(request.key);
+            break;
+        }
+    }
+    return count;
+}
+
+// Run the calling thread on one CPU; failure (or no support) is ignored
+template <typename Key, typename Value>
+void PipelinedLRUCache<Key, Value>::pin(size_t cpu) {
+#if defined(__linux__)
+    unsigned cpus = std::thread::hardware_concurrency();
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus > 0 ? cpu % cpus : 0, &set);
+    ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+#endif // PIPELINED_LRU_HPP
@@ -0,0 +1,190 @@
+// sampled_lru.hpp
+
+#pragma once
+
+#ifndef SAMPLED_LRU_HPP
+#define SAMPLED_LRU_HPP
+
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "hashtable.hpp"
+#include "paged_vector.hpp"
+
+// Approximate LRU cache with no recency list, in the style of Redis.
+//
+// Each entry carries only a 32-bit access stamp, kept in an array parallel
+// to the table's dense storage, so a hit writes 4 bytes instead of relinking
+// list nodes. To evict, the cache samples `samples` random entries, merges
+// them into a small pool of the least recently used candidates seen so far,
+// and evicts the oldest candidate that has not been touched since it was
+// sampled. More samples approach true LRU at the cost of slower evictions.
+//
+// Stamps come from a 32-bit access counter; an entry idle for more than
+// 2^32 accesses looks recent again, which only makes eviction less exact.
+template <typename Key, typename Value>
+class SampledLRUCache {
+public:
+    static constexpr size_t kPoolSize = 16;
+
+    explicit SampledLRUCache(size_t capacity, size_t samples = 5)
+        : capacity_(capacity), samples_(samples), clock_(0), rng_(0x9E3779B97F4A7C15ULL) {
+        if (capacity_ >= Map::npos) {
+            throw std::invalid_argument("SampledLRUCache capacity is too large");
+        }
+        if (samples_ == 0) {
+            throw std::invalid_argument("SampledLRUCache needs at least one sample");
+        }
+        pool_.reserve(kPoolSize);
+    }
+
+    void put(const Key& key, const Value& value) {
+        if (capacity_ == 0) {
+            return;
+        }
+        uint32_t index = map_.find_index(key);
+        if (index != Map::npos) {
+            map_.entry_at(index).value = value;
+            touch(index);
+            return;
+        }
+        if (map_.size() == capacity_) {
+            evict();
+        }
+        grow();
+        map_.insert(key, value);
+        stamps_.push_back(++clock_);
+    }
+
+    Value get(const Key& key) {
+        uint32_t index = map_.find_index(key);
+        if (index == Map::npos) {
+            throw std::runtime_error("Key not found");
+        }
+        touch(index);
+        return map_.entry_at(index).value;
+    }
+
+    // Like get(), but returns nullptr instead of throwing on a miss. The
+    // pointer is valid until the next call that modifies the cache.
+    Value* find(const Key& key) {
+        uint32_t index = map_.find_index(key);
+        if (index == Map::npos) {
+            return nullptr;
+        }
+        touch(index);
+        return &map_.entry_at(index).value;
+    }
+
+    bool contains(const Key& key) const {
+        return map_.find_index(key) != Map::npos;
+    }
+
+    size_t size() const { return map_.size(); }
+    size_t capacity() const { return capacity_; }
+
+    void clear() {
+        map_.clear();
+        stamps_.clear();
+        pool_.clear();
+    }
+
+    // Heap bytes held by the cache's storage
+    size_t memory_usage() const {
+        return map_.memory_usage() + stamps_.capacity() * sizeof(uint32_t) + pool_.capacity() * sizeof(Candidate);
+    }
+
+private:
+    struct Candidate {
+        Key key;
+        uint32_t stamp; // Stamp when sampled; a different one means it was touched
+    };
+
+    using Map = HashTable<Key, Value>;
+
+    Map map_;
+    PagedVector<uint32_t> stamps_; // Per table position: clock at last access
+    std::vector<Candidate> pool_;  // Eviction candidates, least idle first
+    size_t capacity_;
+    size_t samples_;
+    uint32_t clock_;
+    uint64_t rng_;
+
+    uint32_t idle(uint32_t stamp) const { return clock_ - stamp; }
+
+    void touch(uint32_t index) {
+        stamps_[index] = ++clock_;
+        if (map_.rehashing()) {
+            map_.rehash_step(); // Hits drive a pending rehash too, not just inserts
+        }
+    }
+
+    // xorshift64*
+    size_t random_position() {
+        rng_ ^= rng_ >> 12;
+        rng_ ^= rng_ << 25;
+        rng_ ^= rng_ >> 27;
+        return static_cast<size_t>((rng_ * 0x2545F4914F6CDD1DULL) >> 32) % map_.size();
+    }
+
+    // Grow storage geometrically, but never past capacity_, as LRUCache does
+    void grow() {
+        if (map_.size() == map_.entry_capacity()) {
+            size_t target = map_.size() < 8 ? 8 : map_.size() * 2;
+            target = target < capacity_ ? target : capacity_;
+            map_.reserve(target);
+            stamps_.reserve(target);
+        }
+    }
+
+    // Merge a fresh sample into the pool, which stays sorted by idle time
+    // and keeps the kPoolSize oldest candidates
+    void sample() {
+        for (size_t n = 0; n < samples_; ++n) {
+            uint32_t position = static_cast<uint32_t>(random_position());
+            const Key& key = map_.entry_at(position).key;
+            uint32_t stamp = stamps_[position];
+            bool pooled = false;
+            for (const Candidate& c : pool_) {
+                pooled = pooled || c.key == key;
+            }
+            if (pooled) continue;
+            if (pool_.size() == kPoolSize) {
+                if (idle(stamp) <= idle(pool_.front().stamp)) continue;
+                pool_.erase(pool_.begin());
+            }
+            auto at = pool_.begin();
+            while (at != pool_.end() && idle(at->stamp) < idle(stamp)) {
+                ++at;
+            }
+            pool_.insert(at, Candidate{ key, stamp });
+        }
+    }
+
+    void evict() {
+        sample();
+        while (!pool_.empty()) {
+            Candidate oldest = std::move(pool_.back());
+            pool_.pop_back();
+            uint32_t index = map_.find_index(oldest.key);
+            if (index != Map::npos && stamps_[index] == oldest.stamp) {
+                erase_at(index);
+                return;
+            }
+            // Evicted or touched since it was sampled; try the next one
+        }
+        erase_at(static_cast<uint32_t>(random_position()));
+    }
+
+    void erase_at(uint32_t index) {
+        // The table fills the hole with its last entry; its stamp follows
+        uint32_t moved = map_.erase_at(index);
+        if (moved != Map::npos) {
+            stamps_[index] = stamps_[moved];
+        }
+        stamps_.pop_back();
+    }
+};
+
+#endif // SAMPLED_LRU_HPP
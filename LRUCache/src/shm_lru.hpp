@@ -0,0 +1,449 @@
+// shm_lru.hpp
+
+#pragma once
+
+#ifndef SHM_LRU_HPP
+#define SHM_LRU_HPP
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SHM_LRU_HAS_POSIX_SHM 1
+#else
+#define SHM_LRU_HAS_POSIX_SHM 0
+#endif
+
+// Robust process-shared mutexes: the next locker is told when the owner died
+// holding the lock, instead of waiting forever
+#if defined(__linux__) || defined(__FreeBSD__)
+#include <pthread.h>
+#define SHM_LRU_ROBUST_LOCK 1
+#else
+#define SHM_LRU_ROBUST_LOCK 0
+#endif
+
+// LRU cache whose whole state lives in one fixed-size memory region, so that
+// several processes can map the same region and share a single copy.
+//
+// Nothing in the region is a pointer: slots are addressed by index, both the
+// hash chains and the recency list link slots by index, and the region may be
+// mapped at a different address in every process. Keys and values are stored
+// inline and must be trivially copyable. All processes must agree on
+// std::hash<Key> (i.e. run the same build).
+//
+// Every operation holds a lock in the region. Where robust mutexes exist
+// (Linux, FreeBSD) a process that dies holding it does not wedge the others:
+// the next process to lock it empties the cache, since the dead process may
+// have left it half updated, and carries on. Elsewhere the lock is a spin
+// lock and a process must not die while inside an operation.
+template <typename Key, typename Value>
+class SharedLRUCache {
+    static_assert(std::is_trivially_copyable_v<Key>, "SharedLRUCache keys must be trivially copyable");
+    static_assert(std::is_trivially_copyable_v<Value>, "SharedLRUCache values must be trivially copyable");
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "Process-shared lock needs a lock-free atomic");
+
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    // Bytes needed for a region holding `capacity` entries
+    static size_t required_size(size_t capacity) {
+        return sizeof(Header) + capacity * sizeof(Slot) + bucket_count_for(capacity) * sizeof(uint32_t);
+    }
+
+    // Initialize `region` as an empty cache. The region must stay mapped for
+    // the lifetime of the returned object.
+    static SharedLRUCache format(void* region, size_t bytes, size_t capacity) {
+        check_capacity(capacity);
+        if (bytes < required_size(capacity)) {
+            throw std::invalid_argument("Region too small for SharedLRUCache");
+        }
+        Header* header = static_cast<Header*>(region);
+        header->ready.store(0, std::memory_order_relaxed);
+        std::memcpy(header->magic, kMagic, sizeof(header->magic));
+        header->key_size = sizeof(Key);
+        header->value_size = sizeof(Value);
+        header->capacity = static_cast<uint32_t>(capacity);
+        header->bucket_count = static_cast<uint32_t>(bucket_count_for(capacity));
+        init_lock(*header);
+
+        SharedLRUCache cache(region, bytes, false);
+        cache.reset();
+        header->ready.store(1, std::memory_order_release);
+        return cache;
+    }
+
+    // Use a region already formatted (possibly by another process)
+    static SharedLRUCache attach(void* region, size_t bytes) {
+        if (bytes < sizeof(Header)) {
+            throw std::invalid_argument("Region too small for SharedLRUCache");
+        }
+        const Header* header = static_cast<const Header*>(region);
+        if (header->ready.load(std::memory_order_acquire) != 1 ||
+            std::memcmp(header->magic, kMagic, sizeof(header->magic)) != 0) {
+            throw std::runtime_error("Region does not hold a SharedLRUCache");
+        }
+        if (header->key_size != sizeof(Key) || header->value_size != sizeof(Value)) {
+            throw std::runtime_error("SharedLRUCache was created for different key/value types");
+        }
+        if (bytes < required_size(header->capacity)) {
+            throw std::runtime_error("SharedLRUCache region is truncated");
+        }
+        return SharedLRUCache(region, bytes, false);
+    }
+
+#if SHM_LRU_HAS_POSIX_SHM
+    // Create a named POSIX shared memory object (name starts with '/')
+    static SharedLRUCache create(const std::string& name, size_t capacity) {
+        check_capacity(capacity); // Before the name exists
+        size_t bytes = required_size(capacity);
+        int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot create shared memory: " + name);
+        }
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            throw std::runtime_error("Cannot size shared memory: " + name);
+        }
+        void* region = map(fd, bytes);
+        if (!region) {
+            ::shm_unlink(name.c_str());
+            throw std::runtime_error("Cannot map shared memory: " + name);
+        }
+        try {
+            SharedLRUCache cache = format(region, bytes, capacity);
+            cache.owns_mapping_ = true;
+            return cache;
+        }
+        catch (...) {
+            ::munmap(region, bytes);
+            ::shm_unlink(name.c_str());
+            throw;
+        }
+    }
+
+    // Attach to a named cache made by create()
+    static SharedLRUCache open(const std::string& name) {
+        int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open shared memory: " + name);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot stat shared memory: " + name);
+        }
+        size_t bytes = static_cast<size_t>(st.st_size);
+        void* region = map(fd, bytes);
+        if (!region) {
+            throw std::runtime_error("Cannot map shared memory: " + name);
+        }
+        try {
+            SharedLRUCache cache = attach(region, bytes);
+            cache.owns_mapping_ = true;
+            return cache;
+        }
+        catch (...) {
+            ::munmap(region, bytes);
+            throw;
+        }
+    }
+
+    // Remove the name; mappings already made stay valid
+    static void remove(const std::string& name) {
+        ::shm_unlink(name.c_str());
+    }
+#endif
+
+    SharedLRUCache(SharedLRUCache&& other) noexcept
+        : region_(other.region_), bytes_(other.bytes_), owns_mapping_(other.owns_mapping_) {
+        other.region_ = nullptr;
+        other.owns_mapping_ = false;
+    }
+
+    SharedLRUCache& operator=(SharedLRUCache&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            region_ = other.region_;
+            bytes_ = other.bytes_;
+            owns_mapping_ = other.owns_mapping_;
+            other.region_ = nullptr;
+            other.owns_mapping_ = false;
+        }
+        return *this;
+    }
+
+    SharedLRUCache(const SharedLRUCache&) = delete;
+    SharedLRUCache& operator=(const SharedLRUCache&) = delete;
+
+    ~SharedLRUCache() { unmap(); }
+
+    void put(const Key& key, const Value& value) {
+        Guard guard(*this);
+        uint32_t bucket = bucket_of(key);
+        uint32_t idx = lookup(key, bucket);
+        if (idx != npos) {
+            slot(idx).value = value;
+            touch(idx);
+            return;
+        }
+        if (header().size == header().capacity) {
+            evict();
+        }
+        idx = header().free_head;
+        Slot& s = slot(idx);
+        header().free_head = s.next;
+        s.key = key;
+        s.value = value;
+        s.chain = buckets()[bucket];
+        buckets()[bucket] = idx;
+        link_front(idx);
+        ++header().size;
+    }
+
+    Value get(const Key& key) {
+        Guard guard(*this);
+        uint32_t idx = lookup(key, bucket_of(key));
+        if (idx == npos) {
+            throw std::runtime_error("Key not found");
+        }
+        touch(idx);
+        return slot(idx).value;
+    }
+
+    bool contains(const Key& key) {
+        Guard guard(*this);
+        return lookup(key, bucket_of(key)) != npos;
+    }
+
+    size_t size() const {
+        Guard guard(*this);
+        return header().size;
+    }
+
+    size_t capacity() const {
+        return header().capacity;
+    }
+
+    void clear() {
+        Guard guard(*this);
+        reset();
+    }
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t key_size;
+        uint32_t value_size;
+        uint32_t capacity;
+        uint32_t bucket_count;
+#if SHM_LRU_ROBUST_LOCK
+        pthread_mutex_t lock;
+#else
+        std::atomic<uint32_t> lock;
+#endif
+        std::atomic<uint32_t> ready;
+        uint32_t size;
+        uint32_t head;
+        uint32_t tail;
+        uint32_t free_head;
+    };
+
+    struct Slot {
+        Key key;
+        Value value;
+        uint32_t prev;
+        uint32_t next;  // Recency list, or free list when unused
+        uint32_t chain; // Next slot in the same hash bucket
+    };
+
+    // Holds the lock living in the shared header
+    class Guard {
+    public:
+        explicit Guard(const SharedLRUCache& cache) : header_(cache.header()) {
+#if SHM_LRU_ROBUST_LOCK
+            int rc = ::pthread_mutex_lock(&header_.lock);
+            if (rc == EOWNERDEAD) {
+                // The owner died mid-operation: drop whatever it left
+                cache.reset();
+                rc = ::pthread_mutex_consistent(&header_.lock);
+                if (rc != 0) {
+                    // Still ours: release it so that other processes get
+                    // ENOTRECOVERABLE instead of blocking forever
+                    ::pthread_mutex_unlock(&header_.lock);
+                }
+            }
+            if (rc != 0) {
+                throw std::runtime_error("Cannot lock SharedLRUCache");
+            }
+#else
+            std::atomic<uint32_t>& lock = header_.lock;
+            for (unsigned spins = 0; lock.exchange(1, std::memory_order_acquire) != 0; ++spins) {
+                while (lock.load(std::memory_order_relaxed) != 0) {
+                    if (++spins > 64) std::this_thread::yield();
+                }
+            }
+#endif
+        }
+        ~Guard() {
+#if SHM_LRU_ROBUST_LOCK
+            ::pthread_mutex_unlock(&header_.lock);
+#else
+            header_.lock.store(0, std::memory_order_release);
+#endif
+        }
+
+    private:
+        Header& header_;
+    };
+
+    static void init_lock(Header& header) {
+#if SHM_LRU_ROBUST_LOCK
+        pthread_mutexattr_t attr;
+        ::pthread_mutexattr_init(&attr);
+        ::pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        ::pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        int rc = ::pthread_mutex_init(&header.lock, &attr);
+        ::pthread_mutexattr_destroy(&attr);
+        if (rc != 0) {
+            throw std::runtime_error("Cannot create SharedLRUCache lock");
+        }
+#else
+        header.lock.store(0, std::memory_order_relaxed);
+#endif
+    }
+
+    static_assert(sizeof(Header) % alignof(Slot) == 0, "Slots must be aligned after the header");
+
+    static constexpr char kMagic[8] = { 'S', 'H', 'M', 'L', 'R', 'U', '2', '\0' };
+
+    SharedLRUCache(void* region, size_t bytes, bool owns_mapping)
+        : region_(static_cast<char*>(region)), bytes_(bytes), owns_mapping_(owns_mapping) {
+    }
+
+    static void check_capacity(size_t capacity) {
+        if (capacity == 0 || capacity >= npos) {
+            throw std::invalid_argument("SharedLRUCache capacity out of range");
+        }
+    }
+
+    static size_t bucket_count_for(size_t capacity) {
+        return capacity + capacity / 2 + 1;
+    }
+
+#if SHM_LRU_HAS_POSIX_SHM
+    static void* map(int fd, size_t bytes) {
+        void* region = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        return region == MAP_FAILED ? nullptr : region;
+    }
+#endif
+
+    void unmap() {
+#if SHM_LRU_HAS_POSIX_SHM
+        if (owns_mapping_ && region_) {
+            ::munmap(region_, bytes_);
+        }
+#endif
+        region_ = nullptr;
+    }
+
+    Header& header() const { return *reinterpret_cast<Header*>(region_); }
+    Slot& slot(uint32_t idx) const {
+        return reinterpret_cast<Slot*>(region_ + sizeof(Header))[idx];
+    }
+    uint32_t* buckets() const {
+        return reinterpret_cast<uint32_t*>(region_ + sizeof(Header) + header().capacity * sizeof(Slot));
+    }
+
+    uint32_t bucket_of(const Key& key) const {
+        return static_cast<uint32_t>(std::hash<Key>{}(key) % header().bucket_count);
+    }
+
+    uint32_t lookup(const Key& key, uint32_t bucket) const {
+        for (uint32_t idx = buckets()[bucket]; idx != npos; idx = slot(idx).chain) {
+            if (slot(idx).key == key) return idx;
+        }
+        return npos;
+    }
+
+    // Put every slot on the free list and empty the buckets
+    void reset() const {
+        Header& h = header();
+        for (uint32_t i = 0; i < h.capacity; ++i) {
+            slot(i).next = i + 1 < h.capacity ? i + 1 : npos;
+        }
+        for (uint32_t b = 0; b < h.bucket_count; ++b) {
+            buckets()[b] = npos;
+        }
+        h.size = 0;
+        h.head = npos;
+        h.tail = npos;
+        h.free_head = 0;
+    }
+
+    void link_front(uint32_t idx) {
+        Header& h = header();
+        Slot& s = slot(idx);
+        s.prev = npos;
+        s.next = h.head;
+        if (h.head != npos) {
+            slot(h.head).prev = idx;
+        }
+        else {
+            h.tail = idx;
+        }
+        h.head = idx;
+    }
+
+    void unlink(uint32_t idx) {
+        Header& h = header();
+        Slot& s = slot(idx);
+        if (s.prev != npos) slot(s.prev).next = s.next;
+        else h.head = s.next;
+        if (s.next != npos) slot(s.next).prev = s.prev;
+        else h.tail = s.prev;
+    }
+
+    void touch(uint32_t idx) {
+        if (idx == header().head) return; // Already at the front
+        unlink(idx);
+        link_front(idx);
+    }
+
+    void evict() {
+        Header& h = header();
+        uint32_t idx = h.tail;
+        if (idx == npos) return;
+        unlink(idx);
+
+        // Unhook the slot from its hash chain
+        uint32_t* link = &buckets()[bucket_of(slot(idx).key)];
+        while (*link != idx) {
+            link = &slot(*link).chain;
+        }
+        *link = slot(idx).chain;
+
+        slot(idx).next = h.free_head;
+        h.free_head = idx;
+        --h.size;
+    }
+
+    char* region_;
+    size_t bytes_;
+    bool owns_mapping_;
+};
+
+#endif // SHM_LRU_HPP
@@ -0,0 +1,243 @@
+// snapshot.hpp
+
+#pragma once
+
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SNAPSHOT_HAS_MMAP 1
+#else
+#include <vector>
+#define SNAPSHOT_HAS_MMAP 0
+#endif
+
+#ifdef _WIN32
+#include <filesystem>
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+// On-disk layout (native endianness):
+//   SnapshotHeader
+//   count x { key, value }   entries in MRU -> LRU order
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t key_format;   // SnapshotSerializer<Key>::format
+    uint32_t value_format; // SnapshotSerializer<Value>::format
+    uint32_t reserved;
+    uint64_t count;
+};
+
+constexpr char kSnapshotMagic[8] = { 'L', 'R', 'U', 'S', 'N', 'A', 'P', '\0' };
+constexpr uint32_t kSnapshotVersion = 1;
+
+// Bounds-checked cursor over the bytes of a loaded snapshot
+class SnapshotReader {
+public:
+    SnapshotReader(const char* data, size_t size) : pos_(data), end_(data + size) {}
+
+    const char* take(size_t bytes) {
+        if (static_cast<size_t>(end_ - pos_) < bytes) {
+            throw std::runtime_error("Snapshot is truncated");
+        }
+        const char* start = pos_;
+        pos_ += bytes;
+        return start;
+    }
+
+    bool at_end() const { return pos_ == end_; }
+
+private:
+    const char* pos_;
+    const char* end_;
+};
+
+// Serializer used by LRUCache::save/load. Specialize it (or pass a custom
+// serializer to save/load) to snapshot types that are not trivially copyable.
+// A serializer provides:
+//   static constexpr uint32_t format;   // stored in the header, checked on load
+//   static void write(std::ostream&, const T&);
+//   static T read(SnapshotReader&);
+//   static void skip(SnapshotReader&);  // optional: step over a record
+template <typename T, typename Enable = void>
+struct SnapshotSerializer;
+
+// Step over one record without building it, where the serializer can
+template <typename Serializer>
+void snapshot_skip(SnapshotReader& in) {
+    if constexpr (requires { Serializer::skip(in); }) {
+        Serializer::skip(in);
+    }
+    else {
+        Serializer::read(in);
+    }
+}
+
+template <typename T>
+struct SnapshotSerializer<T, std::enable_if_t<std::is_trivially_copyable_v<T>>> {
+    static constexpr uint32_t format = static_cast<uint32_t>(sizeof(T));
+
+    static void write(std::ostream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    static T read(SnapshotReader& in) {
+        T value;
+        std::memcpy(&value, in.take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    static void skip(SnapshotReader& in) {
+        in.take(sizeof(T));
+    }
+};
+
+// Strings are stored as a 32-bit length followed by the characters
+template <typename Char, typename Traits, typename Alloc>
+struct SnapshotSerializer<std::basic_string<Char, Traits, Alloc>> {
+    using String = std::basic_string<Char, Traits, Alloc>;
+    static constexpr uint32_t format = 0x80000000u | static_cast<uint32_t>(sizeof(Char));
+
+    static void write(std::ostream& out, const String& value) {
+        uint32_t length = static_cast<uint32_t>(value.size());
+        out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.write(reinterpret_cast<const char*>(value.data()), length * sizeof(Char));
+    }
+
+    static String read(SnapshotReader& in) {
+        uint32_t length;
+        std::memcpy(&length, in.take(sizeof(length)), sizeof(length));
+        const char* chars = in.take(static_cast<size_t>(length) * sizeof(Char));
+        String value(length, Char());
+        std::memcpy(value.data(), chars, static_cast<size_t>(length) * sizeof(Char));
+        return value;
+    }
+
+    static void skip(SnapshotReader& in) {
+        uint32_t length;
+        std::memcpy(&length, in.take(sizeof(length)), sizeof(length));
+        in.take(static_cast<size_t>(length) * sizeof(Char));
+    }
+};
+
+// Read-only view of a whole file. Uses mmap where available so that loading
+// a large snapshot does not copy it through a userspace buffer first.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#if SNAPSHOT_HAS_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open snapshot: " + path);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot stat snapshot: " + path);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ > 0) {
+            void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Cannot map snapshot: " + path);
+            }
+            ::madvise(addr, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(addr);
+        }
+        ::close(fd);
+#else
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) {
+            throw std::runtime_error("Cannot open snapshot: " + path);
+        }
+        buffer_.resize(static_cast<size_t>(in.tellg()));
+        in.seekg(0);
+        in.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+#endif
+    }
+
+    ~MappedFile() {
+#if SNAPSHOT_HAS_MMAP
+        if (data_) {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#if !SNAPSHOT_HAS_MMAP
+    std::vector<char> buffer_;
+#endif
+};
+
+// Move the finished snapshot at `from` over `to`, replacing any previous
+// one. On POSIX and Windows the data is flushed to disk first and the
+// replace is a single durable rename, so that after a crash `to` holds
+// either the old snapshot or the new one. Returns false on failure.
+inline bool replace_snapshot_file(const std::string& from, const std::string& to) {
+#if SNAPSHOT_HAS_MMAP
+    int fd = ::open(from.c_str(), O_RDWR);
+    if (fd < 0) {
+        return false;
+    }
+    bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    if (!synced || std::rename(from.c_str(), to.c_str()) != 0) {
+        return false;
+    }
+    // Persist the directory entry as well
+    size_t slash = to.find_last_of('/');
+    std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : to.substr(0, slash));
+    int dir_fd = ::open(dir.c_str(), O_RDONLY);
+    if (dir_fd >= 0) {
+        ::fsync(dir_fd);
+        ::close(dir_fd);
+    }
+    return true;
+#elif defined(_WIN32)
+    std::wstring wide_from = std::filesystem::path(from).wstring();
+    std::wstring wide_to = std::filesystem::path(to).wstring();
+    HANDLE file = ::CreateFileW(wide_from.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    bool flushed = ::FlushFileBuffers(file) != 0;
+    ::CloseHandle(file);
+    // std::rename cannot replace an existing file here
+    return flushed && ::MoveFileExW(wide_from.c_str(), wide_to.c_str(),
+                                    MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    std::remove(to.c_str());
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+#endif // SNAPSHOT_HPP
@@ -0,0 +1,88 @@
+// spsc_queue.hpp
+
+#pragma once
+
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+// Bounded queue for exactly one producer thread and one consumer thread.
+// Both ends are wait-free: a push or pop is a handful of loads and one
+// release store, with no read-modify-write.
+//
+// The producer owns `tail_` and the consumer `head_`, each on its own cache
+// line. Each side also keeps a private copy of the other side's index and
+// only reloads it when the copy says the queue is full (or empty), so in a
+// steady stream the two cores rarely touch each other's lines. Slots hold
+// default-constructed values until first written.
+template <typename T>
+class SpscQueue {
+public:
+    // Holds at least `capacity` elements; rounded up to a power of two
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        mask_ = size - 1;
+        slots_.reset(new T[size]);
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side. Returns false, leaving `value` untouched, if the queue
+    // is full.
+    bool try_push(T&& value) { return push(std::move(value)); }
+    bool try_push(const T& value) { return push(value); }
+
+    // Consumer side. Returns false if the queue is empty.
+    bool try_pop(T& out) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+        out = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Exact only when called from one of the two ends while the other is
+    // idle; otherwise a snapshot
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    template <typename U>
+    bool push(U&& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ > mask_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = std::forward<U>(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    alignas(64) std::atomic<size_t> head_{ 0 }; // Next slot to pop; written by the consumer
+    size_t cached_tail_ = 0;                     // Consumer's copy of tail_
+    alignas(64) std::atomic<size_t> tail_{ 0 }; // Next slot to push; written by the producer
+    size_t cached_head_ = 0;                     // Producer's copy of head_
+    alignas(64) size_t mask_ = 0;
+    std::unique_ptr<T[]> slots_;
+};
+
+#endif // SPSC_QUEUE_HPP
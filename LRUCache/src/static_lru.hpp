@@ -0,0 +1,245 @@
+// static_lru.hpp
+
+#pragma once
+
+#ifndef STATIC_LRU_HPP
+#define STATIC_LRU_HPP
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define STATIC_LRU_HAS_SSE2 1
+#else
+#define STATIC_LRU_HAS_SSE2 0
+#endif
+
+// Smallest unsigned type able to hold every entry index plus a "none" value
+template <size_t N>
+using static_link_t = std::conditional_t<(N < UINT8_MAX), uint8_t,
+                      std::conditional_t<(N < UINT16_MAX), uint16_t, uint32_t>>;
+
+// Hash usable in constant expressions for integral and enum keys; other
+// keys fall back to std::hash (so only work at run time).
+template <typename Key>
+struct StaticHash {
+    constexpr size_t operator()(const Key& key) const {
+        if constexpr (std::is_integral_v<Key> || std::is_enum_v<Key>) {
+            // 64-bit finalizer from MurmurHash3
+            uint64_t h = static_cast<uint64_t>(key);
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+            return static_cast<size_t>(h);
+        }
+        else {
+            return std::hash<Key>{}(key);
+        }
+    }
+};
+
+// Fixed-capacity LRU cache with all storage inline, for small caches that
+// live on the stack or inside other objects. Nothing is ever allocated.
+//
+// Entries are kept in parallel arrays linked by the smallest index type that
+// fits N. Up to `linear_scan_limit` entries, lookups scan the key array
+// (with SSE2 for 4- and 8-byte integral keys); larger caches add an
+// open-addressed index of 2N..4N slots. Key and Value must be default
+// constructible. Everything is constexpr, so integral-keyed caches can be
+// built and queried in constant expressions.
+template <typename Key, typename Value, size_t N, typename Hash = StaticHash<Key>>
+class StaticLRUCache {
+    static_assert(N > 0, "StaticLRUCache needs room for at least one entry");
+    static_assert(N < UINT32_MAX, "StaticLRUCache capacity is too large");
+
+public:
+    using link_type = static_link_t<N>;
+
+    static constexpr link_type npos = std::numeric_limits<link_type>::max();
+    static constexpr size_t linear_scan_limit = 16;
+    static constexpr bool uses_index = N > linear_scan_limit;
+    static constexpr size_t index_size = uses_index ? std::bit_ceil(2 * N) : 0;
+
+    constexpr StaticLRUCache() {
+        index_.fill(npos);
+    }
+
+    constexpr void put(const Key& key, const Value& value) {
+        link_type idx = lookup(key);
+        if (idx != npos) {
+            values_[idx] = value;
+            touch(idx);
+            return;
+        }
+        if (size_ < N) {
+            idx = static_cast<link_type>(size_++);
+        }
+        else {
+            // Reuse the least recently used entry's storage
+            idx = tail_;
+            unlink(idx);
+            if constexpr (uses_index) {
+                index_erase(idx);
+            }
+        }
+        keys_[idx] = key;
+        values_[idx] = value;
+        link_front(idx);
+        if constexpr (uses_index) {
+            index_insert(idx);
+        }
+    }
+
+    constexpr Value get(const Key& key) {
+        Value* value = find(key);
+        if (!value) {
+            throw std::runtime_error("Key not found");
+        }
+        return *value;
+    }
+
+    // Value for `key` (marking it most recently used), or nullptr
+    constexpr Value* find(const Key& key) {
+        link_type idx = lookup(key);
+        if (idx == npos) {
+            return nullptr;
+        }
+        touch(idx);
+        return &values_[idx];
+    }
+
+    constexpr bool contains(const Key& key) const {
+        return lookup(key) != npos;
+    }
+
+    constexpr size_t size() const { return size_; }
+    static constexpr size_t capacity() { return N; }
+
+    constexpr void clear() {
+        size_ = 0;
+        head_ = npos;
+        tail_ = npos;
+        index_.fill(npos);
+    }
+
+    // Keys from most to least recently used
+    template <typename Fn>
+    constexpr void for_each(Fn&& fn) const {
+        for (link_type idx = head_; idx != npos; idx = next_[idx]) {
+            fn(keys_[idx], values_[idx]);
+        }
+    }
+
+private:
+    constexpr link_type lookup(const Key& key) const {
+        if constexpr (uses_index) {
+            size_t mask = index_size - 1;
+            for (size_t slot = Hash{}(key) & mask; index_[slot] != npos; slot = (slot + 1) & mask) {
+                if (keys_[index_[slot]] == key) return index_[slot];
+            }
+            return npos;
+        }
+        else {
+            return scan(key);
+        }
+    }
+
+    constexpr link_type scan(const Key& key) const {
+        size_t i = 0;
+#if STATIC_LRU_HAS_SSE2
+        if constexpr (std::is_integral_v<Key> && (sizeof(Key) == 4 || sizeof(Key) == 8)) {
+            if (!std::is_constant_evaluated()) {
+                constexpr size_t lanes = 16 / sizeof(Key);
+                __m128i needle = sizeof(Key) == 4 ? _mm_set1_epi32(static_cast<int>(key))
+                                                  : _mm_set1_epi64x(static_cast<long long>(key));
+                for (; i + lanes <= size_; i += lanes) {
+                    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&keys_[i]));
+                    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi32(chunk, needle)));
+                    // A key matches when all of its bytes compared equal
+                    for (size_t lane = 0; lane < lanes; ++lane) {
+                        unsigned bits = (mask >> (lane * sizeof(Key))) & ((1u << sizeof(Key)) - 1);
+                        if (bits == (1u << sizeof(Key)) - 1) return static_cast<link_type>(i + lane);
+                    }
+                }
+            }
+        }
+#endif
+        for (; i < size_; ++i) {
+            if (keys_[i] == key) return static_cast<link_type>(i);
+        }
+        return npos;
+    }
+
+    constexpr void index_insert(link_type idx) {
+        size_t mask = index_size - 1;
+        size_t slot = Hash{}(keys_[idx]) & mask;
+        while (index_[slot] != npos) {
+            slot = (slot + 1) & mask;
+        }
+        index_[slot] = idx;
+    }
+
+    // Backward-shift deletion keeps probe chains intact without tombstones
+    constexpr void index_erase(link_type idx) {
+        size_t mask = index_size - 1;
+        size_t slot = Hash{}(keys_[idx]) & mask;
+        while (index_[slot] != idx) {
+            slot = (slot + 1) & mask;
+        }
+        size_t hole = slot;
+        for (size_t next = (hole + 1) & mask; index_[next] != npos; next = (next + 1) & mask) {
+            size_t home = Hash{}(keys_[index_[next]]) & mask;
+            // Move the entry back unless its home lies in (hole, next]
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                index_[hole] = index_[next];
+                hole = next;
+            }
+        }
+        index_[hole] = npos;
+    }
+
+    constexpr void link_front(link_type idx) {
+        prev_[idx] = npos;
+        next_[idx] = head_;
+        if (head_ != npos) {
+            prev_[head_] = idx;
+        }
+        else {
+            tail_ = idx;
+        }
+        head_ = idx;
+    }
+
+    constexpr void unlink(link_type idx) {
+        if (prev_[idx] != npos) next_[prev_[idx]] = next_[idx];
+        else head_ = next_[idx];
+        if (next_[idx] != npos) prev_[next_[idx]] = prev_[idx];
+        else tail_ = prev_[idx];
+    }
+
+    constexpr void touch(link_type idx) {
+        if (idx == head_) return; // Already at the front
+        unlink(idx);
+        link_front(idx);
+    }
+
+    std::array<Key, N> keys_{};
+    std::array<Value, N> values_{};
+    std::array<link_type, N> prev_{};
+    std::array<link_type, N> next_{};
+    std::array<link_type, index_size> index_{};
+    link_type head_ = npos;
+    link_type tail_ = npos;
+    size_t size_ = 0;
+};
+
+#endif // STATIC_LRU_HPP
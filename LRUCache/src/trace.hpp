@@ -0,0 +1,192 @@
+// trace.hpp
+
+#pragma once
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+// Tracing policies for HashTable and LRUCache. A policy is a type with
+//
+//   static constexpr bool enabled;
+//   static void begin(TraceEvent, uint64_t arg);       // Synchronous span
+//   static void end(TraceEvent);
+//   static void instant(TraceEvent, uint64_t arg);
+//   static void async_begin(TraceEvent, uint64_t id);  // Span crossing calls
+//   static void async_end(TraceEvent, uint64_t id);
+//
+// NoTrace, the default, has empty inline bodies and callers only compute
+// arguments under `if constexpr (Trace::enabled)`, so an untraced build
+// contains no trace code at all.
+enum class TraceEvent : uint8_t {
+    Put,       // LRUCache::put
+    Evict,     // One eviction
+    Grow,      // Storage growth (allocation) in LRUCache
+    Allocate,  // Allocation of a hash index; arg = slots
+    Rehash,    // Synchronous part of a rehash; arg = new slot count
+    Migrate,   // Incremental rehash, from start until the old index drains
+    LongProbe, // Lookup or insert that probed at least kLongProbe slots; arg = probes
+};
+
+inline const char* trace_event_name(TraceEvent event) {
+    switch (event) {
+    case TraceEvent::Put: return "put";
+    case TraceEvent::Evict: return "evict";
+    case TraceEvent::Grow: return "grow";
+    case TraceEvent::Allocate: return "allocate";
+    case TraceEvent::Rehash: return "rehash";
+    case TraceEvent::Migrate: return "migrate";
+    case TraceEvent::LongProbe: return "long_probe";
+    }
+    return "unknown";
+}
+
+struct NoTrace {
+    static constexpr bool enabled = false;
+    static void begin(TraceEvent, uint64_t = 0) {}
+    static void end(TraceEvent) {}
+    static void instant(TraceEvent, uint64_t = 0) {}
+    static void async_begin(TraceEvent, uint64_t) {}
+    static void async_end(TraceEvent, uint64_t) {}
+};
+
+// Records events into a ring buffer per thread. Recording is wait-free: a
+// thread only ever writes its own ring, and the first event on a thread
+// registers that ring once under a lock. Each ring keeps the last
+// kCapacity events; rings outlive their threads so that a dump still shows
+// them.
+//
+// dump() writes every ring as Chrome trace event JSON, which Perfetto and
+// chrome://tracing load directly. Take the dump while the traced threads
+// are quiet (for instance after reproducing a spike); events written during
+// a dump may be missing from it or garbled.
+class RingTrace {
+public:
+    static constexpr bool enabled = true;
+    static constexpr size_t kCapacity = size_t(1) << 16;
+
+    static void begin(TraceEvent event, uint64_t arg = 0) { record(event, 'B', arg); }
+    static void end(TraceEvent event) { record(event, 'E', 0); }
+    static void instant(TraceEvent event, uint64_t arg = 0) { record(event, 'i', arg); }
+    static void async_begin(TraceEvent event, uint64_t id) { record(event, 'b', id); }
+    static void async_end(TraceEvent event, uint64_t id) { record(event, 'e', id); }
+
+    static void dump(std::ostream& out);
+
+    // Drop every recorded event
+    static void reset() {
+        Registry& registry = registry_instance();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (auto& ring : registry.rings) {
+            ring->head.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct Record {
+        uint64_t time_ns;
+        uint64_t arg;
+        TraceEvent event;
+        char phase; // Chrome trace phase: B, E, i, b or e
+    };
+
+    struct Ring {
+        std::atomic<uint64_t> head{ 0 }; // Events ever written; the slot is head % kCapacity
+        uint32_t tid = 0;
+        std::unique_ptr<Record[]> records{ new Record[kCapacity] };
+    };
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<Ring>> rings;
+    };
+
+    static Registry& registry_instance() {
+        static Registry registry;
+        return registry;
+    }
+
+    static Ring& local_ring() {
+        thread_local std::shared_ptr<Ring> ring = [] {
+            auto created = std::make_shared<Ring>();
+            Registry& registry = registry_instance();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            created->tid = static_cast<uint32_t>(registry.rings.size() + 1);
+            registry.rings.push_back(created);
+            return created;
+        }();
+        return *ring;
+    }
+
+    static void record(TraceEvent event, char phase, uint64_t arg) {
+        Ring& ring = local_ring();
+        uint64_t head = ring.head.load(std::memory_order_relaxed);
+        uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+        ring.records[head % kCapacity] = Record{ now, arg, event, phase };
+        ring.head.store(head + 1, std::memory_order_release);
+    }
+};
+
+// Dump method
+inline void RingTrace::dump(std::ostream& out) {
+    Registry& registry = registry_instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for (const auto& ring : registry.rings) {
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t start = head > kCapacity ? head - kCapacity : 0;
+        for (uint64_t i = start; i < head; ++i) {
+            const Record& r = ring->records[i % kCapacity];
+            out << (first ? "\n" : ",\n");
+            first = false;
+            out << "{\"name\":\"" << trace_event_name(r.event) << "\",\"cat\":\"cache\",\"ph\":\"" << r.phase
+                << "\",\"ts\":" << r.time_ns / 1000 << '.' << static_cast<char>('0' + r.time_ns / 100 % 10)
+                << static_cast<char>('0' + r.time_ns / 10 % 10) << static_cast<char>('0' + r.time_ns % 10)
+                << ",\"pid\":1,\"tid\":" << ring->tid;
+            if (r.phase == 'b' || r.phase == 'e') {
+                out << ",\"id\":" << r.arg;
+            }
+            else if (r.phase == 'i') {
+                out << ",\"s\":\"t\",\"args\":{\"value\":" << r.arg << '}';
+            }
+            else if (r.phase == 'B') {
+                out << ",\"args\":{\"value\":" << r.arg << '}';
+            }
+            out << '}';
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+// Traces a synchronous span for the lifetime of the object
+template <typename Trace>
+class TraceScope {
+public:
+    explicit TraceScope(TraceEvent event, uint64_t arg = 0) : event_(event) {
+        Trace::begin(event, arg);
+    }
+    ~TraceScope() { Trace::end(event_); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    TraceEvent event_;
+};
+
+template <>
+class TraceScope<NoTrace> {
+public:
+    explicit TraceScope(TraceEvent, uint64_t = 0) {}
+};
+
+#endif // TRACE_HPP
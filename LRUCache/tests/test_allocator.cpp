@@ -0,0 +1,87 @@
+// tests/test_allocator.cpp
+#include "../src/allocator.hpp"
+#include "../src/lru.hpp"
+#include <gtest/gtest.h>
+#include <cstring>
+
+namespace {
+
+void fill_and_check(void* p, size_t bytes) {
+    std::memset(p, 0x5A, bytes);
+    auto* bytes_p = static_cast<unsigned char*>(p);
+    EXPECT_EQ(bytes_p[0], 0x5A);
+    EXPECT_EQ(bytes_p[bytes - 1], 0x5A);
+}
+
+} // namespace
+
+TEST(AllocatorTest, DefaultAllocatorRoundTrip) {
+    DefaultAllocator alloc;
+    void* p = alloc.allocate(1000, 64);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % 64, 0u);
+    fill_and_check(p, 1000);
+    alloc.deallocate(p, 1000, 64);
+}
+
+TEST(AllocatorTest, HugePageBlocksAreAligned) {
+    HugePageAllocator alloc;
+    size_t bytes = 3 * HugePageAllocator::kHugePageSize + 100;
+    void* p = alloc.allocate(bytes, 8);
+    ASSERT_NE(p, nullptr);
+#if ALLOCATOR_HAS_MMAP
+    // Huge-page sized mappings start on a huge page boundary, whichever
+    // backing the system provided
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % HugePageAllocator::kHugePageSize, 0u);
+#endif
+    fill_and_check(p, bytes);
+    alloc.deallocate(p, bytes, 8);
+
+    EXPECT_EQ(HugePageAllocator::mapped_length(bytes), 4 * HugePageAllocator::kHugePageSize);
+    EXPECT_EQ(HugePageAllocator::mapped_length(100000), 102400u);
+}
+
+TEST(AllocatorTest, SmallAndMidSizedBlocks) {
+    HugePageAllocator alloc;
+    for (size_t bytes : { size_t(16), size_t(4096), HugePageAllocator::kMinMappedBytes, size_t(300000) }) {
+        void* p = alloc.allocate(bytes, 8);
+        ASSERT_NE(p, nullptr) << bytes;
+        fill_and_check(p, bytes);
+        alloc.deallocate(p, bytes, 8);
+    }
+}
+
+TEST(AllocatorTest, NumaBindingFallsBackGracefully) {
+    // Node 0 exists everywhere; node 900 almost certainly does not, and
+    // the allocation must still succeed
+    for (int node : { 0, 900, 100000 }) {
+        HugePageAllocator alloc(node);
+        EXPECT_EQ(alloc.numa_node(), node);
+        void* p = alloc.allocate(HugePageAllocator::kHugePageSize, 8);
+        fill_and_check(p, HugePageAllocator::kHugePageSize);
+        alloc.deallocate(p, HugePageAllocator::kHugePageSize, 8);
+    }
+}
+
+TEST(AllocatorTest, PagesFillWholeHugePages) {
+    using Pages = PagedVector<uint64_t, HugePageAllocator>;
+    EXPECT_EQ(Pages::kPageSize * sizeof(uint64_t), HugePageAllocator::kHugePageSize);
+
+    Pages values;
+    for (uint64_t i = 0; i < 3 * Pages::kPageSize; ++i) {
+        values.push_back(i);
+    }
+    for (uint64_t i = 0; i < 3 * Pages::kPageSize; i += 997) {
+        EXPECT_EQ(values[i], i);
+    }
+}
+
+TEST(AllocatorTest, CacheOnHugePages) {
+    LRUCache<uint64_t, uint64_t, HugePageAllocator> cache(200000, HugePageAllocator(0));
+    for (uint64_t i = 0; i < 300000; ++i) {
+        cache.put(i, i * 3);
+    }
+    EXPECT_EQ(cache.size(), 200000);
+    EXPECT_FALSE(cache.contains(99999));
+    EXPECT_EQ(cache.get(100000), 300000u);
+    EXPECT_EQ(cache.get(299999), 899997u);
+}
@@ -0,0 +1,152 @@
+// tests/test_compressed_lru.cpp
+#include "../src/compressed_lru.hpp"
+#include "../src/codec.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+
+namespace {
+
+// A few KB of JSON with the usual repetition of field names
+std::string json_blob(int seed) {
+    std::string json = "{\"items\":[";
+    for (int i = 0; i < 40; ++i) {
+        json += "{\"id\":" + std::to_string(seed * 1000 + i) + ",\"name\":\"item-" + std::to_string(i) +
+                "\",\"price\":" + std::to_string((seed + i) % 97) + ".99,\"tags\":[\"new\",\"sale\"],\"in_stock\":" +
+                (i % 3 ? "true" : "false") + "},";
+    }
+    json.back() = ']';
+    return json + "}";
+}
+
+std::string random_bytes(size_t size, uint64_t seed) {
+    std::string bytes(size, '\0');
+    for (char& c : bytes) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        c = static_cast<char>(seed);
+    }
+    return bytes;
+}
+
+std::string round_trip(const std::string& input) {
+    LZCodec codec;
+    std::string compressed;
+    if (!codec.compress(input, compressed)) {
+        return input;
+    }
+    EXPECT_LT(compressed.size(), input.size());
+    std::string output(input.size(), '\0');
+    codec.decompress(compressed, &output[0], output.size());
+    return output;
+}
+
+} // namespace
+
+TEST(LZCodecTest, RoundTrips) {
+    EXPECT_EQ(round_trip(""), "");
+    EXPECT_EQ(round_trip("abc"), "abc");
+    EXPECT_EQ(round_trip(std::string(100000, 'x')), std::string(100000, 'x')); // Overlapping matches
+    EXPECT_EQ(round_trip(json_blob(1)), json_blob(1));
+    std::string pattern;
+    for (int i = 0; i < 5000; ++i) {
+        pattern += "ab" + std::to_string(i % 7);
+    }
+    EXPECT_EQ(round_trip(pattern), pattern);
+
+    // Long literal runs and matches beyond the 64 KB window
+    std::string far = random_bytes(70000, 1);
+    far += far.substr(0, 1000) + random_bytes(300, 2) + far.substr(69000, 1000);
+    EXPECT_EQ(round_trip(far), far);
+}
+
+TEST(LZCodecTest, CompressesJsonAndRejectsNoise) {
+    LZCodec codec;
+    std::string compressed;
+    std::string json = json_blob(7);
+    ASSERT_TRUE(codec.compress(json, compressed));
+    EXPECT_GT(json.size(), 3 * compressed.size()) << json.size() << " -> " << compressed.size();
+    EXPECT_FALSE(codec.compress(random_bytes(4096, 3), compressed));
+}
+
+TEST(LZCodecTest, CorruptInputThrows) {
+    LZCodec codec;
+    std::string compressed;
+    std::string json = json_blob(2);
+    ASSERT_TRUE(codec.compress(json, compressed));
+    std::string output(json.size(), '\0');
+    EXPECT_THROW(codec.decompress(compressed.substr(0, compressed.size() / 2), &output[0], output.size()),
+                 std::runtime_error);
+    EXPECT_THROW(codec.decompress(compressed, &output[0], output.size() - 1), std::runtime_error);
+    EXPECT_THROW(codec.decompress("", &output[0], output.size()), std::runtime_error);
+}
+
+TEST(CompressedLRUCacheTest, StoreAndRetrieve) {
+    CompressedLRUCache<int> cache(1 << 20);
+    cache.put(1, "short");
+    cache.put(2, json_blob(2));
+    EXPECT_EQ(cache.get(1), "short");
+    EXPECT_EQ(cache.get(2), json_blob(2));
+    EXPECT_THROW(cache.get(3), std::runtime_error);
+
+    std::string buffer;
+    EXPECT_TRUE(cache.find(2, buffer));
+    EXPECT_EQ(buffer, json_blob(2));
+    EXPECT_FALSE(cache.find(3, buffer));
+
+    // Only the large value was compressed
+    EXPECT_EQ(cache.raw_weight(), 5 + json_blob(2).size());
+    EXPECT_LT(cache.weight(), 5 + json_blob(2).size() / 3);
+}
+
+TEST(CompressedLRUCacheTest, WeighsCompressedSize) {
+    size_t blob = json_blob(0).size();
+    CompressedLRUCache<int> compressed(blob * 10);
+    CompressedLRUCache<int, IdentityCodec> plain(blob * 10);
+    for (int i = 0; i < 100; ++i) {
+        compressed.put(i, json_blob(i));
+        plain.put(i, json_blob(i));
+    }
+    EXPECT_LE(plain.size(), 10);
+    EXPECT_GE(compressed.size(), 3 * plain.size());
+    EXPECT_LE(compressed.weight(), compressed.capacity());
+    EXPECT_EQ(compressed.get(99), json_blob(99));
+    EXPECT_FALSE(compressed.contains(0));
+}
+
+TEST(CompressedLRUCacheTest, EvictsLeastRecentlyUsed) {
+    CompressedLRUCache<int> cache(300, 64);
+    cache.put(1, std::string(100, 'a'));    // Compressed to a few bytes
+    cache.put(2, random_bytes(100, 1));     // Stored verbatim
+    cache.put(3, random_bytes(150, 2));
+    EXPECT_EQ(cache.size(), 3);
+    EXPECT_EQ(cache.get(2), random_bytes(100, 1));
+
+    cache.put(4, random_bytes(100, 3)); // Evicts 1, then 3
+    EXPECT_FALSE(cache.contains(1));
+    EXPECT_FALSE(cache.contains(3));
+    EXPECT_TRUE(cache.contains(2));
+    EXPECT_EQ(cache.weight(), 200);
+
+    // Too big to cache at all; also drops the old value
+    cache.put(2, random_bytes(301, 4));
+    EXPECT_FALSE(cache.contains(2));
+    EXPECT_EQ(cache.weight(), 100);
+}
+
+TEST(CompressedLRUCacheTest, UpdateAndErase) {
+    CompressedLRUCache<std::string> cache(1 << 16);
+    cache.put("a", json_blob(1));
+    cache.put("b", "plain");
+    cache.put("a", "now short");
+    EXPECT_EQ(cache.get("a"), "now short");
+    EXPECT_EQ(cache.weight(), 14);
+    EXPECT_TRUE(cache.erase("a"));
+    EXPECT_FALSE(cache.erase("a"));
+    EXPECT_EQ(cache.weight(), 5);
+    EXPECT_EQ(cache.get("b"), "plain");
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.weight(), 0);
+}
@@ -0,0 +1,142 @@
+// tests/test_concurrent_hashtable.cpp
+#include "../src/concurrent_hashtable.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(ConcurrentHashTableTest, InsertFindErase) {
+    ConcurrentHashTable<int, std::string> table;
+    EXPECT_TRUE(table.insert(1, "one"));
+    EXPECT_TRUE(table.insert(2, "two"));
+    EXPECT_EQ(table.find(1), "one");
+    EXPECT_EQ(table.find(3), std::nullopt);
+
+    EXPECT_TRUE(table.insert(1, "uno"));
+    EXPECT_EQ(table.find(1), "uno");
+    EXPECT_EQ(table.size(), 2);
+
+    EXPECT_TRUE(table.erase(1));
+    EXPECT_FALSE(table.erase(1));
+    EXPECT_FALSE(table.contains(1));
+    EXPECT_EQ(table.size(), 1);
+}
+
+TEST(ConcurrentHashTableTest, VisitDoesNotCopy) {
+    ConcurrentHashTable<int, std::vector<int>> table;
+    table.insert(7, std::vector<int>(1000, 7));
+    size_t seen = 0;
+    EXPECT_TRUE(table.visit(7, [&](const std::vector<int>& v) { seen = v.size(); }));
+    EXPECT_EQ(seen, 1000);
+    EXPECT_FALSE(table.visit(8, [&](const std::vector<int>&) { FAIL(); }));
+}
+
+TEST(ConcurrentHashTableTest, GrowsAndReusesTombstones) {
+    ConcurrentHashTable<int, int> table;
+    for (int i = 0; i < 10000; ++i) {
+        table.insert(i, i);
+    }
+    EXPECT_GE(table.capacity(), 10000 * 4 / 3);
+    for (int i = 0; i < 10000; i += 2) {
+        table.erase(i);
+    }
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < 10000; i += 2) {
+            table.insert(i + 20000, i);
+            table.erase(i + 20000);
+        }
+    }
+    EXPECT_EQ(table.size(), 5000);
+    for (int i = 0; i < 10000; ++i) {
+        EXPECT_EQ(table.contains(i), i % 2 == 1) << i;
+    }
+    table.clear();
+    EXPECT_EQ(table.size(), 0);
+    EXPECT_FALSE(table.contains(1));
+}
+
+TEST(ConcurrentHashTableTest, CollectFreesRetiredNodes) {
+    ConcurrentHashTable<int, int> table;
+    for (int i = 0; i < 10; ++i) {
+        table.insert(1, i); // Each update retires the previous node
+    }
+    EXPECT_EQ(table.collect(), 0);
+}
+
+TEST(ConcurrentHashTableTest, ReadersBeyondPinSlotsDoNotWait) {
+    // More lookups in flight than there are pin slots; the extra readers
+    // must still get in, and hold back reclamation while they run
+    ConcurrentHashTable<int, int> table;
+    table.insert(1, 1);
+    constexpr int kReaders = static_cast<int>(ConcurrentHashTable<int, int>::kMaxReaders) + 4;
+    std::atomic<int> entered{ 0 };
+    std::atomic<bool> release{ false };
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < kReaders; ++r) {
+        readers.emplace_back([&] {
+            table.visit(1, [&](const int&) {
+                entered.fetch_add(1);
+                while (!release.load()) {
+                    std::this_thread::yield();
+                }
+            });
+        });
+    }
+    while (entered.load() < kReaders) {
+        std::this_thread::yield();
+    }
+
+    table.insert(1, 2); // Retires the node every reader is looking at
+    EXPECT_GT(table.collect(), 0);
+    release = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(table.collect(), 0);
+    EXPECT_EQ(table.find(1), 2);
+}
+
+TEST(ConcurrentHashTableTest, ReadersRunDuringWritesAndResizes) {
+    // Values encode their key, so a reader can tell a torn or freed node
+    // from a valid one; ASan flags any node reclaimed too early
+    ConcurrentHashTable<int, std::string> table;
+    constexpr int kKeys = 2000;
+    std::atomic<bool> done{ false };
+    std::atomic<long> hits{ 0 };
+    std::atomic<int> bad{ 0 };
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&, r] {
+            long local_hits = 0;
+            for (int i = r; !done.load(std::memory_order_relaxed); i = (i + 7) % kKeys) {
+                auto value = table.find(i);
+                if (value) {
+                    ++local_hits;
+                    if (value->compare(0, value->find(':'), std::to_string(i)) != 0) {
+                        bad.fetch_add(1);
+                    }
+                }
+            }
+            hits.fetch_add(local_hits);
+        });
+    }
+
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < kKeys; ++i) {
+            table.insert(i, std::to_string(i) + ":" + std::to_string(round));
+        }
+        for (int i = round % 2; i < kKeys; i += 2) {
+            table.erase(i);
+        }
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(bad.load(), 0);
+    EXPECT_GT(hits.load(), 0);
+    EXPECT_EQ(table.collect(), 0);
+}
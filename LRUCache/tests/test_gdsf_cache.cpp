@@ -0,0 +1,118 @@
+// tests/test_gdsf_cache.cpp
+#include "../src/gdsf_cache.hpp"
+#include <gtest/gtest.h>
+#include <string>
+
+TEST(GDSFCacheTest, StoreAndRetrieve) {
+    GDSFCache<int, std::string> cache(2);
+    cache.put(1, "One");
+    cache.put(2, "Two");
+    EXPECT_EQ(cache.get(1), "One");
+    EXPECT_EQ(cache.get(2), "Two");
+    EXPECT_THROW(cache.get(3), std::runtime_error);
+    EXPECT_EQ(cache.find(3), nullptr);
+    EXPECT_EQ(cache.size(), 2);
+}
+
+TEST(GDSFCacheTest, EvictsCheapEntriesFirst) {
+    GDSFCache<int, int> cache(3);
+    cache.put(1, 1, 500.0); // Expensive to recompute
+    cache.put(2, 2, 1.0);
+    cache.put(3, 3, 1.0);
+
+    // Both cheap entries go before the expensive one, even though it is
+    // the least recently used
+    cache.put(4, 4, 1.0);
+    cache.put(5, 5, 1.0);
+    EXPECT_TRUE(cache.contains(1));
+    EXPECT_FALSE(cache.contains(2));
+    EXPECT_FALSE(cache.contains(3));
+}
+
+TEST(GDSFCacheTest, FrequencyRaisesPriority) {
+    GDSFCache<int, int> cache(2);
+    cache.put(1, 1, 10.0);
+    cache.put(2, 2, 10.0);
+    cache.get(1);
+    cache.get(1);
+    cache.put(3, 3, 10.0); // 2 has the lowest frequency
+    EXPECT_TRUE(cache.contains(1));
+    EXPECT_FALSE(cache.contains(2));
+}
+
+TEST(GDSFCacheTest, SizeCountsAgainstCapacity) {
+    GDSFCache<int, int> cache(10);
+    cache.put(1, 1, 10.0, 8); // Priority 10 / 8
+    cache.put(2, 2, 10.0, 1); // Priority 10
+    EXPECT_EQ(cache.weight(), 9);
+
+    cache.put(3, 3, 10.0, 4); // Needs 3 more units: the large entry goes
+    EXPECT_FALSE(cache.contains(1));
+    EXPECT_TRUE(cache.contains(2));
+    EXPECT_EQ(cache.weight(), 5);
+
+    cache.put(4, 4, 1.0, 11); // Larger than the whole cache
+    EXPECT_FALSE(cache.contains(4));
+    EXPECT_EQ(cache.weight(), 5);
+}
+
+TEST(GDSFCacheTest, InflationAgesOutStaleEntries) {
+    GDSFCache<int, int> cache(2);
+    cache.put(1, 1, 5.0);
+    for (int i = 0; i < 10; ++i) {
+        cache.put(100 + i, i, 1.0);
+        cache.get(100 + i);
+        cache.get(100 + i);
+    }
+    // Each eviction raises L, so fresh entries eventually outrank the
+    // once-expensive key that is never hit again
+    EXPECT_GT(cache.inflation(), 5.0);
+    EXPECT_FALSE(cache.contains(1));
+}
+
+TEST(GDSFCacheTest, UpdateGrowsEntryWithoutEvictingIt) {
+    GDSFCache<int, int> cache(4);
+    for (int key = 1; key <= 4; ++key) {
+        cache.put(key, key);
+    }
+    cache.put(2, 20, 1.0, 3); // Two others make room for it
+    EXPECT_EQ(cache.get(2), 20);
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_EQ(cache.weight(), 4);
+
+    cache.put(2, 21, 1.0, 5); // No longer fits at all
+    EXPECT_FALSE(cache.contains(2));
+    EXPECT_LE(cache.weight(), 4);
+}
+
+TEST(GDSFCacheTest, InflationStopsAtKeptEntryWhenEvictingPastIt) {
+    GDSFCache<int, int> cache(3);
+    cache.put(1, 1, 1.0);
+    cache.put(2, 2, 5.0);
+    cache.put(3, 3, 10.0);
+    // Key 1 grows to priority 2 * 1 / 2 = 1 and stays at the root, so key 2
+    // (priority 5) goes in its place; L must not jump past the kept entry
+    cache.put(1, 1, 1.0, 2);
+    EXPECT_FALSE(cache.contains(2));
+    EXPECT_TRUE(cache.contains(1));
+    EXPECT_DOUBLE_EQ(cache.inflation(), 1.0);
+}
+
+TEST(GDSFCacheTest, HeapStaysConsistentUnderChurn) {
+    GDSFCache<int, int> cache(100);
+    for (int i = 0; i < 20000; ++i) {
+        int key = (i * 7919) % 1000;
+        if (cache.find(key) == nullptr) {
+            cache.put(key, i, 1.0 + (key % 17), 1 + key % 3);
+        }
+        ASSERT_LE(cache.weight(), 100);
+    }
+    size_t present = 0;
+    for (int key = 0; key < 1000; ++key) {
+        present += cache.contains(key);
+    }
+    EXPECT_EQ(present, cache.size());
+    cache.clear();
+    EXPECT_EQ(cache.weight(), 0);
+    EXPECT_EQ(cache.size(), 0);
+}
@@ -1,4 +1,6 @@
 #include "../src/hashtable.hpp"
+#include <utility>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -301,3 +303,288 @@ TEST(HashTableTest, EraseAndFindNonExistentKey) {
 
 
 
+TEST(HashTableTest, ReinsertIntoErasedSlot) {
+    HashTable<int, std::string> table;
+
+    // 1 and 17 share a home slot in a 16-slot table
+    table.insert(1, "one");
+    table.erase(1);
+    EXPECT_TRUE(table.insert(17, "seventeen"));
+
+    std::string* result = table.find(17);
+    ASSERT_NE(result, nullptr);
+    EXPECT_EQ(*result, "seventeen");
+    EXPECT_EQ(table.find(1), nullptr);
+    EXPECT_EQ(table.size(), 1);
+}
+
+TEST(HashTableTest, UpdateDoesNotChangeSize) {
+    HashTable<int, std::string> table;
+    table.insert(1, "one");
+    table.insert(1, "uno");
+    EXPECT_EQ(table.size(), 1);
+
+    // The key must not be duplicated when an erased slot precedes it
+    table.insert(17, "seventeen");
+    table.erase(1);
+    table.insert(17, "diecisiete");
+    EXPECT_EQ(table.size(), 1);
+    table.erase(17);
+    EXPECT_EQ(table.find(17), nullptr);
+}
+
+TEST(HashTableTest, Reserve) {
+    HashTable<int, int> table;
+    table.reserve(100);
+
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(table.insert(i, i * 2));
+    }
+    EXPECT_EQ(table.size(), 100);
+    ASSERT_NE(table.find(99), nullptr);
+    EXPECT_EQ(*table.find(99), 198);
+}
+
+TEST(HashTableTest, IterationVisitsEveryEntry) {
+    HashTable<int, int> table;
+    for (int i = 0; i < 50; ++i) {
+        table.insert(i, i * i);
+    }
+    table.erase(10);
+    table.erase(49);
+
+    int count = 0;
+    long sum = 0;
+    for (auto& entry : table) {
+        EXPECT_EQ(entry.value, entry.key * entry.key);
+        sum += entry.key;
+        ++count;
+    }
+    EXPECT_EQ(count, 48);
+    EXPECT_EQ(sum, 49 * 50 / 2 - 10 - 49);
+}
+
+TEST(HashTableTest, EraseAtMovesLastEntry) {
+    HashTable<int, std::string> table;
+    table.insert(1, "one");
+    table.insert(2, "two");
+    table.insert(3, "three");
+
+    uint32_t index = table.find_index(1);
+    ASSERT_EQ(index, 0u);
+    EXPECT_EQ(table.erase_at(index), 2u);  // Key 3 moved from position 2
+    EXPECT_EQ(table.entry_at(0).key, 3);
+    EXPECT_EQ(table.find_index(3), 0u);
+    EXPECT_EQ(*table.find(3), "three");
+    EXPECT_EQ(table.find(1), nullptr);
+
+    // Erasing the last position moves nothing
+    EXPECT_EQ(table.erase_at(table.find_index(2)), (HashTable<int, std::string>::npos));
+    EXPECT_EQ(table.size(), 1);
+}
+
+TEST(HashTableTest, ChurnWithErasedSlots) {
+    HashTable<int, int> table;
+
+    // Repeated insert/erase leaves erased slots behind; they must be reclaimed
+    for (int i = 0; i < 10000; ++i) {
+        table.insert(i, i);
+        if (i >= 8) {
+            EXPECT_TRUE(table.erase(i - 8));
+        }
+    }
+    EXPECT_EQ(table.size(), 8);
+    EXPECT_LE(table.capacity(), 64);
+    for (int i = 9992; i < 10000; ++i) {
+        ASSERT_NE(table.find(i), nullptr);
+        EXPECT_EQ(*table.find(i), i);
+    }
+}
+
+TEST(HashTableTest, MemoryUsage) {
+    HashTable<uint64_t, uint64_t> table;
+    table.reserve(1000);
+    for (uint64_t i = 0; i < 1000; ++i) {
+        table.insert(i * 7919, i);
+    }
+    // 16-byte entries plus 5 bytes for each index slot
+    EXPECT_EQ(table.memory_usage(), 1000 * 16 + table.capacity() * 5);
+    EXPECT_LE(table.capacity(), 2048);
+}
+
+TEST(HashTableTest, IncrementalRehashKeepsEveryKeyReachable) {
+    HashTable<int, int> table;
+    bool saw_rehash = false;
+    for (int i = 0; i < 5000; ++i) {
+        table.insert(i, i * 2);
+        saw_rehash = saw_rehash || table.rehashing();
+        // Old and new index are both live mid-migration
+        for (int k = i; k >= 0 && k > i - 20; --k) {
+            ASSERT_NE(table.find(k), nullptr) << k << " after inserting " << i;
+        }
+    }
+    EXPECT_TRUE(saw_rehash);
+    for (int i = 0; i < 5000; ++i) {
+        ASSERT_NE(table.find(i), nullptr) << i;
+        EXPECT_EQ(*table.find(i), i * 2);
+    }
+    EXPECT_EQ(table.find(5000), nullptr);
+}
+
+TEST(HashTableTest, RehashMigratesBoundedSlotsPerInsert) {
+    HashTable<int, int> table(1024);
+    int i = 0;
+    while (!table.rehashing()) {
+        table.insert(i++, 0);
+    }
+    // The insert that started the rehash did not rebuild the whole index
+    size_t inserts = 0;
+    while (table.rehashing()) {
+        table.insert(i++, 0);
+        ++inserts;
+    }
+    EXPECT_GE(inserts, 1024 / (HashTable<int, int>::kRehashStep) - 2);
+    EXPECT_EQ(table.capacity(), 2048);
+    EXPECT_EQ(table.size(), static_cast<size_t>(i));
+}
+
+TEST(HashTableTest, EraseDuringRehash) {
+    HashTable<int, int> table(64);
+    int next = 0;
+    while (!table.rehashing()) {
+        table.insert(next, next + 1);
+        ++next;
+    }
+    // Erase both migrated and not-yet-migrated keys, which moves entries
+    // around in storage while both indexes point at them
+    for (int k = 0; k < next; k += 2) {
+        EXPECT_TRUE(table.erase(k));
+    }
+    for (int k = 0; k < next; ++k) {
+        if (k % 2 == 0) {
+            EXPECT_EQ(table.find(k), nullptr) << k;
+        }
+        else {
+            ASSERT_NE(table.find(k), nullptr) << k;
+            EXPECT_EQ(*table.find(k), k + 1);
+        }
+    }
+    // Re-inserting an erased key must not resurrect its old slot
+    table.insert(0, 100);
+    table.erase(0);
+    EXPECT_EQ(table.find(0), nullptr);
+}
+
+TEST(HashTableTest, RehashStepDrainsOldIndex) {
+    HashTable<int, int> table;
+    int i = 0;
+    while (!table.rehashing()) {
+        table.insert(i++, 0);
+    }
+    size_t both = table.memory_usage();
+    while (table.rehashing()) {
+        table.rehash_step();
+    }
+    EXPECT_LT(table.memory_usage(), both);
+    for (int k = 0; k < i; ++k) {
+        ASSERT_NE(table.find(k), nullptr) << k;
+    }
+}
+
+TEST(HashTableTest, StopTheWorldRehash) {
+    HashTable<int, int> table;
+    table.set_incremental_rehash(false);
+    for (int i = 0; i < 1000; ++i) {
+        table.insert(i, i);
+        EXPECT_FALSE(table.rehashing());
+    }
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_NE(table.find(i), nullptr);
+    }
+}
+
+TEST(HashTableTest, EraseIfCompacts) {
+    HashTable<int, int> table;
+    for (int i = 0; i < 1000; ++i) {
+        table.insert(i, i * 10);
+    }
+    std::vector<std::pair<uint32_t, uint32_t>> moves;
+    size_t erased = table.erase_if(
+        [](const auto& entry, uint32_t) { return entry.key % 3 != 0; },
+        [&](uint32_t from, uint32_t to) { moves.emplace_back(from, to); });
+    EXPECT_EQ(erased, 666);
+    EXPECT_EQ(table.size(), 334);
+    EXPECT_FALSE(table.rehashing());
+    for (const auto& move : moves) {
+        EXPECT_LT(move.second, move.first);
+        EXPECT_EQ(table.entry_at(move.second).key % 3, 0);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        if (i % 3 == 0) {
+            ASSERT_NE(table.find(i), nullptr) << i;
+            EXPECT_EQ(*table.find(i), i * 10);
+            EXPECT_EQ(table.entry_at(table.find_index(i)).key, i);
+        }
+        else {
+            EXPECT_EQ(table.find(i), nullptr) << i;
+        }
+    }
+}
+
+TEST(HashTableTest, ShrinkToFitReleasesMemory) {
+    HashTable<int, int> table;
+    for (int i = 0; i < 100000; ++i) {
+        table.insert(i, i);
+    }
+    for (int i = 100; i < 100000; ++i) {
+        table.erase(i);
+    }
+    size_t full = table.memory_usage(); // Erasing keeps the memory
+    table.shrink_to_fit();
+    EXPECT_FALSE(table.rehashing());
+    EXPECT_EQ(table.capacity(), 256);
+    EXPECT_LT(table.memory_usage(), full / 100);
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_NE(table.find(i), nullptr) << i;
+        EXPECT_EQ(*table.find(i), i);
+    }
+    EXPECT_EQ(table.find(100), nullptr);
+    for (int i = 100; i < 1000; ++i) {
+        table.insert(i, i);
+    }
+    EXPECT_EQ(table.size(), 1000);
+    EXPECT_EQ(*table.find(999), 999);
+}
+
+TEST(HashTableTest, InsertBulkMatchesInsert) {
+    // 200000 keys, the last 50000 repeating earlier ones
+    std::vector<int> keys(200000);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        keys[i] = static_cast<int>(i % 150000) * 7;
+    }
+    for (size_t threads : { 1, 4 }) {
+        HashTable<int, int> table;
+        size_t inserted = table.insert_bulk(
+            keys.size(), [&](size_t i) { return keys[i]; }, [](size_t i) { return static_cast<int>(i); }, threads);
+        EXPECT_EQ(inserted, 150000);
+        EXPECT_EQ(table.size(), 150000);
+        EXPECT_FALSE(table.rehashing());
+        for (int i = 0; i < 150000; ++i) {
+            ASSERT_NE(table.find(i * 7), nullptr) << i;
+            EXPECT_EQ(*table.find(i * 7), i); // First copy kept
+            EXPECT_EQ(table.find_index(i * 7), static_cast<uint32_t>(i)); // Input order kept
+        }
+        EXPECT_EQ(table.find(1), nullptr);
+        EXPECT_TRUE(table.erase(0));
+        table.insert(1, 1);
+        EXPECT_EQ(*table.find(1), 1);
+    }
+
+    // Into a table that is not empty: existing keys win
+    HashTable<int, int> table;
+    table.insert(7, -1);
+    size_t inserted = table.insert_bulk(3, [](size_t i) { return static_cast<int>(i) * 7; }, [](size_t) { return 0; });
+    EXPECT_EQ(inserted, 2);
+    EXPECT_EQ(*table.find(7), -1);
+    EXPECT_EQ(*table.find(14), 0);
+}
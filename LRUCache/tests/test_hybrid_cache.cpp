@@ -0,0 +1,152 @@
+// tests/test_hybrid_cache.cpp
+#include "../src/hybrid_cache.hpp"
+#include "../src/disk_tier.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace {
+
+std::string temp_path(const std::string& name) {
+    return testing::TempDir() + name;
+}
+
+bool file_exists(const std::string& path) {
+    return std::ifstream(path).good();
+}
+
+// Int serializer whose reads fail while `failing` is set
+struct FlakySerializer {
+    static inline bool failing = false;
+    static constexpr uint32_t format = sizeof(int);
+
+    static void write(std::ostream& out, const int& value) {
+        SnapshotSerializer<int>::write(out, value);
+    }
+
+    static int read(SnapshotReader& in) {
+        if (failing) {
+            throw std::runtime_error("Corrupt record");
+        }
+        return SnapshotSerializer<int>::read(in);
+    }
+};
+
+} // namespace
+
+TEST(DiskTierTest, StoreAndRetrieve) {
+    std::string path = temp_path("disk_tier_basic");
+    {
+        DiskTier<int> tier(path, 4096, 4);
+        EXPECT_TRUE(tier.put(1, "one"));
+        EXPECT_TRUE(tier.put(2, ""));
+        EXPECT_TRUE(tier.put(1, "uno"));
+        EXPECT_FALSE(tier.put(3, std::string(4097, 'x'))); // Larger than a segment
+
+        std::string bytes;
+        EXPECT_TRUE(tier.get(1, bytes));
+        EXPECT_EQ(bytes, "uno");
+        EXPECT_TRUE(tier.get(2, bytes));
+        EXPECT_EQ(bytes, "");
+        EXPECT_FALSE(tier.get(3, bytes));
+        EXPECT_TRUE(tier.erase(1));
+        EXPECT_FALSE(tier.contains(1));
+        EXPECT_EQ(tier.size(), 1);
+        EXPECT_TRUE(file_exists(path));
+    }
+    EXPECT_FALSE(file_exists(path));
+}
+
+TEST(DiskTierTest, ReadsSealedSegmentsAndReclaimsOldest) {
+    DiskTier<int> tier(temp_path("disk_tier_ring"), 1000, 4);
+    // 100-byte values: 10 per segment, 40 in the whole ring
+    auto value = [](int key) { return std::string(100, static_cast<char>('a' + key % 26)); };
+    for (int key = 0; key < 35; ++key) {
+        ASSERT_TRUE(tier.put(key, value(key)));
+    }
+    std::string bytes;
+    for (int key = 0; key < 35; ++key) {
+        ASSERT_TRUE(tier.get(key, bytes)) << key;
+        EXPECT_EQ(bytes, value(key));
+    }
+    // Sealing the fourth segment wraps onto the first and drops keys 0-9
+    for (int key = 35; key < 41; ++key) {
+        tier.put(key, value(key));
+    }
+    EXPECT_EQ(tier.size(), 31);
+    for (int key = 0; key < 41; ++key) {
+        EXPECT_EQ(tier.get(key, bytes), key >= 10) << key;
+    }
+    EXPECT_EQ(bytes, value(40));
+}
+
+TEST(HybridCacheTest, SpillsAndPromotes) {
+    HybridCache<int, std::string> cache(10, temp_path("hybrid_spill"), 4096, 8);
+    for (int key = 0; key < 100; ++key) {
+        cache.put(key, "value-" + std::to_string(key));
+    }
+    EXPECT_EQ(cache.memory_size(), 10);
+    EXPECT_EQ(cache.disk_size(), 90);
+    EXPECT_EQ(cache.spills(), 90);
+
+    // Every key is still reachable; the cold ones come back from disk
+    for (int key = 0; key < 100; ++key) {
+        ASSERT_TRUE(cache.contains(key));
+        EXPECT_EQ(cache.get(key), "value-" + std::to_string(key));
+    }
+    EXPECT_EQ(cache.promotions(), 100); // Reading 0-89 pushed 90-99 out too
+    EXPECT_EQ(cache.memory_size() + cache.disk_size(), 100);
+    EXPECT_EQ(cache.memory_size(), 10);
+    EXPECT_THROW(cache.get(100), std::runtime_error);
+    EXPECT_EQ(cache.find(100), nullptr);
+}
+
+TEST(HybridCacheTest, UpdateAndEraseReachBothTiers) {
+    HybridCache<int, int> cache(2, temp_path("hybrid_update"));
+    cache.put(1, 10);
+    cache.put(2, 20);
+    cache.put(3, 30); // 1 spills to disk
+    cache.put(1, 11); // Replaces the disk copy
+    EXPECT_EQ(cache.get(1), 11);
+    EXPECT_EQ(cache.memory_size() + cache.disk_size(), 3);
+
+    EXPECT_TRUE(cache.erase(2));
+    EXPECT_TRUE(cache.erase(3));
+    EXPECT_FALSE(cache.erase(3));
+    EXPECT_FALSE(cache.contains(2));
+    EXPECT_FALSE(cache.contains(3));
+    EXPECT_EQ(cache.get(1), 11);
+
+    EXPECT_THROW((HybridCache<int, int>(0, temp_path("hybrid_empty"))), std::invalid_argument);
+}
+
+TEST(HybridCacheTest, FailedPromotionKeepsDiskCopy) {
+    HybridCache<int, int, FlakySerializer> cache(2, temp_path("hybrid_flaky"));
+    cache.put(1, 10);
+    cache.put(2, 20);
+    cache.put(3, 30); // 1 spills to disk
+
+    FlakySerializer::failing = true;
+    EXPECT_THROW(cache.get(1), std::runtime_error);
+    FlakySerializer::failing = false;
+    EXPECT_TRUE(cache.contains(1));
+    EXPECT_EQ(cache.get(1), 10);
+    EXPECT_EQ(cache.memory_size() + cache.disk_size(), 3);
+}
+
+TEST(HybridCacheTest, ReachIsBoundedByTheRing) {
+    // 4 x 64-byte segments of 4-byte ints: the 3 sealed ones and the active
+    // one hold between 48 and 64 spilled entries
+    HybridCache<int, int> cache(8, temp_path("hybrid_ring"), 64, 4);
+    for (int key = 0; key < 1000; ++key) {
+        cache.put(key, key);
+    }
+    EXPECT_EQ(cache.memory_size(), 8);
+    EXPECT_LE(cache.disk_size(), 64);
+    EXPECT_GT(cache.disk_size(), 32);
+    for (int key = 1000 - 8 - 32; key < 1000; ++key) {
+        EXPECT_EQ(cache.get(key), key);
+    }
+    EXPECT_FALSE(cache.contains(0));
+}
@@ -0,0 +1,43 @@
+// tests/test_inline_string.cpp
+#include "../src/inline_string.hpp"
+#include "../src/lru.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <type_traits>
+
+static_assert(sizeof(InlineString<15>) == 16, "15 characters plus the length byte");
+static_assert(std::is_trivially_copyable_v<InlineString<15>>, "Snapshots copy it as raw bytes");
+
+TEST(InlineStringTest, StoresText) {
+    InlineString<15> s("hello");
+    EXPECT_EQ(s.size(), 5);
+    EXPECT_EQ(s.view(), "hello");
+    EXPECT_EQ(s.str(), std::string("hello"));
+    EXPECT_FALSE(s.empty());
+    EXPECT_TRUE(InlineString<15>().empty());
+}
+
+TEST(InlineStringTest, Equality) {
+    EXPECT_EQ(InlineString<15>("abc"), InlineString<15>("abc"));
+    EXPECT_NE(InlineString<15>("abc"), InlineString<15>("abd"));
+    EXPECT_NE(InlineString<15>("abc"), InlineString<15>("ab"));
+    EXPECT_EQ(std::hash<InlineString<15>>{}("key"), std::hash<InlineString<15>>{}(std::string("key")));
+}
+
+TEST(InlineStringTest, FullCapacityAndOverflow) {
+    InlineString<15> full("123456789012345");
+    EXPECT_EQ(full.size(), 15);
+    EXPECT_EQ(full.view(), "123456789012345");
+    EXPECT_THROW(InlineString<15>("1234567890123456"), std::length_error);
+}
+
+TEST(InlineStringTest, AsCacheKey) {
+    LRUCache<InlineString<15>, int> cache(2);
+    cache.put("alpha", 1);
+    cache.put("beta", 2);
+    EXPECT_EQ(cache.get("alpha"), 1);
+
+    cache.put("gamma", 3);
+    EXPECT_FALSE(cache.contains("beta"));
+    EXPECT_EQ(cache.get("gamma"), 3);
+}
@@ -1,6 +1,7 @@
 // tests/test_intrusive_list.cpp
 #include "../src/intrusive_list.hpp"
 #include <gtest/gtest.h>
+#include <vector>
 
 TEST(IntrusiveListTest, PushFront) {
     IntrusiveList<int> list;
@@ -158,3 +159,35 @@ TEST(IntrusiveListTest, InsertAndClearMultipleTimes) {
 
 
 
+
+TEST(IndexListTest, PushRemoveAndRelocate) {
+    std::vector<IndexLinks> storage(4);
+    auto links = [&](uint32_t i) -> IndexLinks& { return storage[i]; };
+    IndexList list;
+
+    list.push_front(0, links);
+    list.push_front(1, links);
+    list.push_back(2, links);   // 1, 0, 2
+    EXPECT_EQ(list.front(), 1u);
+    EXPECT_EQ(list.back(), 2u);
+    EXPECT_EQ(list.size(), 3);
+
+    list.move_to_front(2, links); // 2, 1, 0
+    EXPECT_EQ(list.front(), 2u);
+    EXPECT_EQ(list.back(), 0u);
+
+    list.remove(1, links);        // 2, 0
+    EXPECT_EQ(storage[2].next, 0u);
+    EXPECT_EQ(storage[0].prev, 2u);
+
+    // Element 0 is moved to slot 3
+    storage[3] = storage[0];
+    list.relocate(0, 3, links);   // 2, 3
+    EXPECT_EQ(list.back(), 3u);
+    EXPECT_EQ(storage[2].next, 3u);
+
+    list.remove(2, links);
+    list.remove(3, links);
+    EXPECT_TRUE(list.empty());
+    EXPECT_EQ(list.front(), IndexList::npos);
+}
@@ -0,0 +1,277 @@
+// tests/test_loading_cache.cpp
+#include "../src/loading_cache.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Clock the tests move by hand
+struct FakeClock {
+    using duration = std::chrono::milliseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<FakeClock>;
+    static constexpr bool is_steady = true;
+
+    static inline duration elapsed{ 0 };
+    static time_point now() { return time_point(elapsed); }
+};
+
+// Executor that queues work until the test runs it
+struct ManualExecutor {
+    std::deque<std::function<void()>> tasks;
+
+    LoadingCache<int, std::string>::Executor handle() {
+        return [this](std::function<void()> task) { tasks.push_back(std::move(task)); };
+    }
+
+    void run_all() {
+        while (!tasks.empty()) {
+            auto task = std::move(tasks.front());
+            tasks.pop_front();
+            task();
+        }
+    }
+};
+
+} // namespace
+
+TEST(LoadingCacheTest, LoadsOnMissAndCaches) {
+    LoadingCache<int, std::string> cache(4);
+    int calls = 0;
+    auto loader = [&](const int& key) { ++calls; return "value" + std::to_string(key); };
+
+    EXPECT_EQ(cache.get(1, loader), "value1");
+    EXPECT_EQ(cache.get(1, loader), "value1");
+    EXPECT_EQ(calls, 1);
+    EXPECT_TRUE(cache.contains(1));
+}
+
+TEST(LoadingCacheTest, CoalescesConcurrentMisses) {
+    ManualExecutor executor;
+    LoadingCache<int, std::string> cache(4, std::chrono::steady_clock::duration::max(),
+                                         std::chrono::steady_clock::duration::max(), executor.handle());
+    int calls = 0;
+    auto loader = [&](const int&) { ++calls; return std::string("loaded"); };
+
+    std::vector<std::shared_future<std::string>> futures;
+    for (int i = 0; i < 5; ++i) {
+        futures.push_back(cache.get_async(7, loader));
+    }
+    EXPECT_EQ(executor.tasks.size(), 1);
+    EXPECT_EQ(cache.loads_in_flight(), 1);
+
+    executor.run_all();
+    EXPECT_EQ(calls, 1);
+    for (auto& future : futures) {
+        EXPECT_EQ(future.get(), "loaded");
+    }
+    EXPECT_EQ(cache.loads_in_flight(), 0);
+    EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(LoadingCacheTest, CoalescesAcrossThreads) {
+    // The first caller runs the load, and its get_async() does not return
+    // until the load does; the load waits until the other seven callers
+    // hold their futures, so all of them found it in flight
+    LoadingCache<int, int> cache(16);
+    constexpr int kThreads = 8;
+    std::atomic<int> calls{ 0 };
+    std::promise<void> all_waiting;
+    std::shared_future<void> released = all_waiting.get_future().share();
+    auto loader = [&](const int& key) {
+        ++calls;
+        released.wait();
+        return key * 2;
+    };
+
+    std::vector<std::thread> threads;
+    std::atomic<int> waiting{ 0 };
+    std::atomic<int> sum{ 0 };
+    for (int i = 0; i < kThreads; ++i) {
+        threads.emplace_back([&] {
+            std::shared_future<int> future = cache.get_async(21, loader);
+            if (++waiting == kThreads - 1) {
+                all_waiting.set_value();
+            }
+            sum += future.get();
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(calls.load(), 1);
+    EXPECT_EQ(sum.load(), kThreads * 42);
+}
+
+TEST(LoadingCacheTest, FailedLoadIsNotCached) {
+    LoadingCache<int, std::string> cache(4);
+    auto failing = [](const int&) -> std::string { throw std::runtime_error("backend down"); };
+
+    auto future = cache.get_async(1, failing);
+    EXPECT_THROW(future.get(), std::runtime_error);
+    EXPECT_FALSE(cache.contains(1));
+    EXPECT_EQ(cache.loads_in_flight(), 0);
+
+    // The next request retries
+    EXPECT_EQ(cache.get(1, [](const int&) { return std::string("ok"); }), "ok");
+}
+
+TEST(LoadingCacheTest, ExpiredEntriesReload) {
+    using namespace std::chrono_literals;
+    FakeClock::elapsed = 0ms;
+    LoadingCache<int, int, FakeClock> cache(4, 100ms);
+    int calls = 0;
+    auto loader = [&](const int&) { return ++calls; };
+
+    EXPECT_EQ(cache.get(1, loader), 1);
+    FakeClock::elapsed = 99ms;
+    EXPECT_EQ(cache.get(1, loader), 1);
+    EXPECT_EQ(cache.get_if_present(1), 1);
+
+    FakeClock::elapsed = 100ms;
+    EXPECT_EQ(cache.get_if_present(1), std::nullopt);
+    EXPECT_EQ(cache.get(1, loader), 2);
+}
+
+TEST(LoadingCacheTest, RefreshAheadServesStaleValue) {
+    using namespace std::chrono_literals;
+    FakeClock::elapsed = 0ms;
+    std::deque<std::function<void()>> tasks;
+    LoadingCache<int, int, FakeClock> cache(4, 100ms, 60ms,
+        [&](std::function<void()> task) { tasks.push_back(std::move(task)); });
+    int calls = 0;
+    auto loader = [&](const int&) { return ++calls; };
+
+    cache.put(1, 0);
+    FakeClock::elapsed = 70ms;
+
+    // Served immediately from the cache while one reload is queued
+    EXPECT_EQ(cache.get_async(1, loader).get(), 0);
+    EXPECT_EQ(cache.get_async(1, loader).get(), 0);
+    ASSERT_EQ(tasks.size(), 1);
+
+    tasks.front()();
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(cache.get_if_present(1), 1);
+
+    // The refreshed entry is fresh again
+    FakeClock::elapsed = 150ms;
+    EXPECT_EQ(cache.get_if_present(1), 1);
+
+    // Without an executor the reload would run inside the hit
+    EXPECT_THROW((LoadingCache<int, int, FakeClock>(4, 100ms, 60ms)), std::invalid_argument);
+}
+
+#if LOADING_CACHE_HAS_COROUTINES
+
+namespace {
+
+// Minimal eager coroutine that runs to completion without being awaited
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+Detached load_into(LoadingCache<int, std::string>& cache, int key,
+                   LoadingCache<int, std::string>::Loader loader, std::string& out) {
+    try {
+        out = co_await cache.co_get_or_load(key, std::move(loader));
+    }
+    catch (const std::exception& e) {
+        out = std::string("error: ") + e.what();
+    }
+}
+
+Detached get_into(LoadingCache<int, std::string>& cache, int key, std::optional<std::string>& out, bool& done) {
+    out = co_await cache.co_get(key);
+    done = true;
+}
+
+} // namespace
+
+TEST(LoadingCacheCoroutineTest, HitCompletesWithoutSuspending) {
+    LoadingCache<int, std::string> cache(4);
+    cache.put(1, "cached");
+
+    auto awaiter = cache.co_get_or_load(1, [](const int&) { return std::string("loaded"); });
+    EXPECT_TRUE(awaiter.await_ready());
+    EXPECT_EQ(awaiter.await_resume(), "cached");
+
+    auto lookup = cache.co_get(1);
+    EXPECT_TRUE(lookup.await_ready());
+    EXPECT_EQ(lookup.await_resume(), "cached");
+}
+
+TEST(LoadingCacheCoroutineTest, MissWithoutExecutorLoadsInline) {
+    LoadingCache<int, std::string> cache(4);
+    std::string out;
+    load_into(cache, 3, [](const int&) { return std::string("three"); }, out);
+    EXPECT_EQ(out, "three");
+    EXPECT_TRUE(cache.contains(3));
+}
+
+TEST(LoadingCacheCoroutineTest, SuspendsUntilSharedLoadCompletes) {
+    ManualExecutor executor;
+    LoadingCache<int, std::string> cache(4, std::chrono::steady_clock::duration::max(),
+                                         std::chrono::steady_clock::duration::max(), executor.handle());
+    int calls = 0;
+    auto loader = [&](const int&) { ++calls; return std::string("shared"); };
+
+    std::string first, second;
+    load_into(cache, 5, loader, first);
+    load_into(cache, 5, loader, second);
+    EXPECT_TRUE(first.empty());
+    EXPECT_TRUE(second.empty());
+    EXPECT_EQ(executor.tasks.size(), 1);
+
+    executor.run_all();
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(first, "shared");
+    EXPECT_EQ(second, "shared");
+}
+
+TEST(LoadingCacheCoroutineTest, GetWaitsOnlyForPendingLoads) {
+    ManualExecutor executor;
+    LoadingCache<int, std::string> cache(4, std::chrono::steady_clock::duration::max(),
+                                         std::chrono::steady_clock::duration::max(), executor.handle());
+
+    // Nothing cached and nothing loading: completes immediately with nullopt
+    std::optional<std::string> value;
+    bool done = false;
+    get_into(cache, 9, value, done);
+    EXPECT_TRUE(done);
+    EXPECT_EQ(value, std::nullopt);
+
+    // With a load in flight the lookup waits for it
+    auto pending = cache.get_async(9, [](const int&) { return std::string("nine"); });
+    done = false;
+    get_into(cache, 9, value, done);
+    EXPECT_FALSE(done);
+
+    executor.run_all();
+    EXPECT_TRUE(done);
+    EXPECT_EQ(value, "nine");
+}
+
+TEST(LoadingCacheCoroutineTest, LoadFailureIsRethrown) {
+    ManualExecutor executor;
+    LoadingCache<int, std::string> cache(4, std::chrono::steady_clock::duration::max(),
+                                         std::chrono::steady_clock::duration::max(), executor.handle());
+    std::string out;
+    load_into(cache, 1, [](const int&) -> std::string { throw std::runtime_error("boom"); }, out);
+    executor.run_all();
+    EXPECT_EQ(out, "error: boom");
+    EXPECT_FALSE(cache.contains(1));
+}
+
+#endif // LOADING_CACHE_HAS_COROUTINES
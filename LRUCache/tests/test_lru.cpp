@@ -1,7 +1,14 @@
 #include "../src/lru.hpp"  // Include the correct header file
+#include "../src/lru_debug.hpp"
 #include <gtest/gtest.h>
+#include <iterator>
+#include <random>
 #include <string>
+#include <utility>
 #include <vector>
+#if __has_include(<ranges>)
+#include <ranges>
+#endif
 
 // Test storing and retrieving from the cache
 TEST(LRUCacheTest, StoreAndRetrieve) {
@@ -36,7 +43,7 @@ TEST(LRUCacheTest, EvictionPolicy) {
     // Add a new entry, evicting the least recently used (2)
     cache.put(4, "Four");
 
-    //cache.print_state();
+    //print_state(cache);
 
     EXPECT_THROW(cache.get(2), std::runtime_error);  // 2 should be evicted
     EXPECT_EQ(cache.get(1), "One");                 // 1 should still be present
@@ -83,7 +90,7 @@ TEST(LRUCacheTest, Display) {
     cache.put(2, "Two");
 
     testing::internal::CaptureStdout();
-    cache.display();
+    display(cache);
     std::string output = testing::internal::GetCapturedStdout();
 
     EXPECT_EQ(output, "2: Two -> 1: One -> NULL\n");
@@ -223,4 +230,571 @@ TEST(LRUCacheTest, InvalidGet) {
     EXPECT_THROW(cache.get(1), std::runtime_error);  // Key does not exist
     cache.put(1, "One");
     EXPECT_NO_THROW(cache.get(1));  // Key exists
-}
\ No newline at end of file
+}
+TEST(LRUCacheTest, EvictionReusesSlots) {
+    LRUCache<int, int> cache(2);
+
+    // Keys 16 apart collide in the index, exercising reuse of evicted slots
+    for (int i = 0; i < 64; ++i) {
+        cache.put(i * 16, i);
+        EXPECT_EQ(cache.get(i * 16), i);
+    }
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_EQ(cache.get(63 * 16), 63);
+    EXPECT_EQ(cache.get(62 * 16), 62);
+}
+
+TEST(LRUCacheTest, FindReturnsPointerAndTouches) {
+    LRUCache<int, std::string> cache(2);
+
+    EXPECT_EQ(cache.find(1), nullptr);
+    cache.put(1, "One");
+    cache.put(2, "Two");
+
+    std::string* value = cache.find(1);
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(*value, "One");
+
+    // find() refreshed key 1, so 2 is evicted
+    cache.put(3, "Three");
+    EXPECT_FALSE(cache.contains(2));
+    EXPECT_TRUE(cache.contains(1));
+}
+
+TEST(LRUCacheTest, EvictionKeepsListAndIndexInSync) {
+    LRUCache<int, int> cache(64);
+
+    // Mixed hits and misses make evictions move entries around storage
+    for (int i = 0; i < 5000; ++i) {
+        cache.put((i * 37) % 211, i);
+        if (i % 3 == 0) cache.find((i * 11) % 211);
+    }
+    EXPECT_EQ(cache.size(), 64);
+
+    testing::internal::CaptureStdout();
+    display(cache);
+    std::string output = testing::internal::GetCapturedStdout();
+    size_t listed = 0;
+    for (size_t pos = output.find(" -> "); pos != std::string::npos; pos = output.find(" -> ", pos + 1)) {
+        ++listed;
+    }
+    EXPECT_EQ(listed, 64);
+
+    int present = 0;
+    for (int key = 0; key < 211; ++key) {
+        present += cache.contains(key);
+    }
+    EXPECT_EQ(present, 64);
+}
+
+TEST(LRUCacheTest, CompactMemoryFootprint) {
+    LRUCache<uint64_t, uint64_t> cache(1000);
+    for (uint64_t i = 0; i < 1000; ++i) {
+        cache.put(i, i);
+    }
+    // 24-byte entries, no slack in storage, 5-byte index slots at <= 75% load
+    EXPECT_LE(cache.memory_usage(), 1000 * 24 + 2048 * 5);
+}
+
+TEST(LRUCacheTest, SegmentedResistsScans) {
+    LRUCache<int, int> cache(10, 0.5);
+
+    // Hot keys are hit twice and reach the protected segment
+    for (int key = 1; key <= 5; ++key) {
+        cache.put(key, key);
+        cache.get(key);
+    }
+    EXPECT_EQ(cache.protected_size(), 5);
+
+    // A scan of one-off keys only churns probation
+    for (int key = 100; key < 200; ++key) {
+        cache.put(key, key);
+    }
+    for (int key = 1; key <= 5; ++key) {
+        EXPECT_TRUE(cache.contains(key)) << key;
+    }
+    EXPECT_EQ(cache.size(), 10);
+
+    // A plain LRU cache loses them all
+    LRUCache<int, int> plain(10);
+    for (int key = 1; key <= 5; ++key) {
+        plain.put(key, key);
+        plain.get(key);
+    }
+    for (int key = 100; key < 200; ++key) {
+        plain.put(key, key);
+    }
+    EXPECT_FALSE(plain.contains(1));
+    EXPECT_EQ(plain.protected_size(), 0);
+}
+
+TEST(LRUCacheTest, SegmentedDemotesProtectedOverflow) {
+    LRUCache<int, int> cache(4, 0.5); // Two protected slots
+    for (int key = 1; key <= 4; ++key) {
+        cache.put(key, key);
+    }
+    cache.get(1);
+    cache.get(2);
+    cache.get(3); // Protected overflows: 1 goes back to the front of probation
+
+    EXPECT_EQ(cache.protected_size(), 2);
+    cache.put(5, 5); // Evicts the probation tail, 4
+    EXPECT_FALSE(cache.contains(4));
+    EXPECT_TRUE(cache.contains(1));
+
+    testing::internal::CaptureStdout();
+    display(cache);
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), "3: 3 -> 2: 2 -> 5: 5 -> 1: 1 -> NULL\n");
+}
+
+TEST(LRUCacheTest, SegmentedChurnKeepsSegmentsConsistent) {
+    LRUCache<int, int> cache(50, 0.8);
+    for (int i = 0; i < 20000; ++i) {
+        cache.put((i * 37) % 301, i);
+        if (i % 2 == 0) cache.find((i * 13) % 97);
+        ASSERT_LE(cache.size(), 50);
+        ASSERT_LE(cache.protected_size(), 40);
+    }
+    int present = 0;
+    for (int key = 0; key < 301; ++key) {
+        present += cache.contains(key);
+    }
+    EXPECT_EQ(present, 50);
+}
+
+TEST(LRUCacheTest, SegmentedRatioValidated) {
+    EXPECT_THROW((LRUCache<int, int>(10, 1.0)), std::invalid_argument);
+    EXPECT_THROW((LRUCache<int, int>(10, -0.1)), std::invalid_argument);
+}
+
+#if defined(__cpp_lib_ranges)
+static_assert(std::ranges::forward_range<LRUCache<int, int>>);
+static_assert(std::ranges::forward_range<const LRUCache<int, int>>);
+static_assert(std::forward_iterator<LRUCache<int, int>::const_iterator>);
+static_assert(std::forward_iterator<HashTable<int, int>::ConstIterator>);
+#endif
+
+TEST(LRUCacheTest, IteratesMostRecentFirst) {
+    LRUCache<int, std::string> cache(3);
+    cache.put(1, "One");
+    cache.put(2, "Two");
+    cache.put(3, "Three");
+    cache.get(1);
+
+    std::vector<int> keys;
+    for (auto [key, value] : cache) {
+        keys.push_back(key);
+    }
+    EXPECT_EQ(keys, (std::vector<int>{ 1, 3, 2 }));
+
+    // Values can be changed in place without touching the entry
+    for (auto item : cache) {
+        item.value += "!";
+    }
+    const auto& view = cache;
+    EXPECT_EQ((*view.begin()).value, "One!");
+    EXPECT_EQ(std::distance(view.begin(), view.end()), 3);
+}
+
+TEST(LRUCacheTest, IteratesBothSegments) {
+    LRUCache<int, int> cache(4, 0.5);
+    for (int key = 1; key <= 4; ++key) {
+        cache.put(key, key);
+    }
+    cache.get(2);
+    std::vector<int> keys;
+    for (auto item : cache) {
+        keys.push_back(item.key);
+    }
+    // Protected (2), then probation MRU -> LRU
+    EXPECT_EQ(keys, (std::vector<int>{ 2, 4, 3, 1 }));
+}
+
+#if defined(__cpp_lib_ranges)
+TEST(LRUCacheTest, WorksWithViews) {
+    LRUCache<int, int> cache(10);
+    for (int key = 0; key < 10; ++key) {
+        cache.put(key, key * key);
+    }
+    std::vector<int> squares;
+    for (int value : cache | std::views::take(3) | std::views::transform([](auto item) { return item.value; })) {
+        squares.push_back(value);
+    }
+    EXPECT_EQ(squares, (std::vector<int>{ 81, 64, 49 }));
+}
+#endif
+
+TEST(LRUCacheTest, HottestAndColdest) {
+    LRUCache<int, int> cache(5);
+    for (int key = 1; key <= 5; ++key) {
+        cache.put(key, key * 10);
+    }
+    std::vector<int> hot, cold;
+    cache.for_each_hottest(2, [&](const int& key, const int&) { hot.push_back(key); });
+    cache.for_each_coldest(2, [&](const int& key, const int&) { cold.push_back(key); });
+    EXPECT_EQ(hot, (std::vector<int>{ 5, 4 }));
+    EXPECT_EQ(cold, (std::vector<int>{ 1, 2 }));
+
+    // Scans do not touch: 1 is still the eviction victim
+    cache.put(6, 60);
+    EXPECT_FALSE(cache.contains(1));
+
+    std::vector<int> all;
+    cache.for_each_coldest(100, [&](const int& key, const int&) { all.push_back(key); });
+    EXPECT_EQ(all, (std::vector<int>{ 2, 3, 4, 5, 6 }));
+}
+
+TEST(LRUCacheTest, DumpToSink) {
+    LRUCache<int, int> cache(3);
+    cache.put(1, 10);
+    cache.put(2, 20);
+    cache.get(1);
+
+    struct Collect {
+        std::string out;
+        void section(const char* name) { out += std::string("[") + name + "]"; }
+        void operator()(const int& key, const int& value) {
+            out += " " + std::to_string(key) + "=" + std::to_string(value);
+        }
+    } sink;
+    cache.dump(sink);
+    EXPECT_EQ(sink.out, "[List] 1=10 2=20[Map] 1=10 2=20");
+
+    testing::internal::CaptureStdout();
+    print_state(cache);
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), "List: 1: 10 -> 2: 20 -> NULL\nMap: 1: 10 -> 2: 20 -> NULL\n");
+}
+
+TEST(LRUCacheTest, InvalidatedIteratorAssertsInDebug) {
+    LRUCache<int, int> cache(3);
+    cache.put(1, 1);
+    auto it = cache.begin();
+    cache.put(2, 2);
+    EXPECT_DEBUG_DEATH(++it, "cache changed");
+}
+
+TEST(LRUCacheTest, EraseKey) {
+    LRUCache<int, std::string> cache(3);
+    cache.put(1, "One");
+    cache.put(2, "Two");
+    cache.put(3, "Three");
+
+    EXPECT_TRUE(cache.erase(2));
+    EXPECT_FALSE(cache.erase(2));
+    EXPECT_FALSE(cache.contains(2));
+    EXPECT_EQ(cache.size(), 2);
+
+    // The freed slot is reused without evicting anything
+    cache.put(4, "Four");
+    EXPECT_TRUE(cache.contains(1));
+    testing::internal::CaptureStdout();
+    display(cache);
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), "4: Four -> 3: Three -> 1: One -> NULL\n");
+}
+
+TEST(LRUCacheTest, EraseIfCompactsInOnePass) {
+    LRUCache<int, int> cache(100, 0.5);
+    for (int key = 0; key < 100; ++key) {
+        cache.put(key, key);
+        if (key % 3 == 0) cache.get(key);
+    }
+    EXPECT_EQ(cache.erase_if([](const int& key, const int&) { return key % 2 == 0; }), 50);
+    EXPECT_EQ(cache.size(), 50);
+
+    // Survivors keep their recency order and stay reachable
+    std::vector<int> keys;
+    for (auto item : cache) {
+        keys.push_back(item.key);
+        EXPECT_EQ(item.key % 2, 1);
+    }
+    EXPECT_EQ(keys.size(), 50);
+    for (int key = 1; key < 100; key += 2) {
+        EXPECT_EQ(cache.get(key), key);
+    }
+    // Eviction still follows the lists after compaction
+    for (int key = 1000; key < 1100; ++key) {
+        cache.put(key, key);
+    }
+    EXPECT_EQ(cache.size(), 100);
+}
+
+TEST(LRUCacheTest, InvalidateTag) {
+    LRUCache<std::string, int> cache(10);
+    cache.put("config:a", 1, 7);
+    cache.put("config:b", 2, 7);
+    cache.put("user:1", 3);         // Tag 0
+    cache.put("session:1", 4, 9);
+
+    cache.invalidate_tag(7);
+    EXPECT_FALSE(cache.contains("config:a"));
+    EXPECT_THROW(cache.get("config:b"), std::runtime_error);
+    EXPECT_EQ(cache.get("user:1"), 3);
+    EXPECT_EQ(cache.get("session:1"), 4);
+
+    // Stale entries vanish from scans, and a fresh put revives the key
+    std::vector<std::string> keys;
+    for (auto item : cache) {
+        keys.push_back(item.key);
+    }
+    EXPECT_EQ(keys, (std::vector<std::string>{ "session:1", "user:1" }));
+    cache.put("config:a", 10, 7);
+    EXPECT_EQ(cache.get("config:a"), 10);
+
+    // Untagged entries have tag 0
+    cache.invalidate_tag(0);
+    EXPECT_FALSE(cache.contains("user:1"));
+    EXPECT_TRUE(cache.contains("session:1"));
+}
+
+TEST(LRUCacheTest, PurgeStale) {
+    LRUCache<int, int> cache(100);
+    for (int key = 0; key < 100; ++key) {
+        cache.put(key, key, static_cast<uint8_t>(key % 4));
+    }
+    cache.invalidate_tag(1);
+    cache.invalidate_tag(2);
+    EXPECT_EQ(cache.size(), 100); // Still held until dropped
+    EXPECT_EQ(cache.purge_stale(), 50);
+    EXPECT_EQ(cache.size(), 50);
+    for (int key = 0; key < 100; ++key) {
+        EXPECT_EQ(cache.contains(key), key % 4 == 0 || key % 4 == 3) << key;
+    }
+    // Tags survive the compaction
+    cache.invalidate_tag(3);
+    EXPECT_EQ(cache.purge_stale(), 25);
+}
+
+TEST(LRUCacheTest, TagsSurviveEvictionChurn) {
+    LRUCache<int, int> cache(32);
+    for (int i = 0; i < 5000; ++i) {
+        cache.put(i % 97, i, static_cast<uint8_t>(i % 97 % 2));
+        if (i % 500 == 499) {
+            cache.invalidate_tag(1);
+            for (int key = 0; key < 97; ++key) {
+                ASSERT_FALSE(key % 2 == 1 && cache.contains(key)) << key;
+            }
+        }
+    }
+    size_t live = 0;
+    for (auto item : cache) {
+        EXPECT_EQ(cache.contains(item.key), true);
+        ++live;
+    }
+    EXPECT_LE(live, 32);
+}
+
+TEST(LRUCacheTest, EvictionListener) {
+    LRUCache<int, std::string> cache(2);
+    std::vector<std::pair<int, std::string>> evicted;
+    cache.set_eviction_listener([&](const int& key, std::string& value) {
+        evicted.emplace_back(key, std::move(value));
+    });
+    cache.put(1, "One");
+    cache.put(2, "Two");
+    cache.get(1);
+    cache.put(3, "Three");
+    cache.erase(1); // Not an eviction
+    cache.put(4, "Four");
+    cache.put(5, "Five");
+    ASSERT_EQ(evicted.size(), 2);
+    EXPECT_EQ(evicted[0], std::make_pair(2, std::string("Two")));
+    EXPECT_EQ(evicted[1], std::make_pair(3, std::string("Three")));
+}
+
+TEST(LRUCacheTest, SetCapacity) {
+    LRUCache<int, int> cache(5);
+    for (int key = 0; key < 5; ++key) {
+        cache.put(key, key);
+    }
+    cache.get(0);
+    cache.set_capacity(3);
+    EXPECT_EQ(cache.capacity(), 3);
+    EXPECT_EQ(cache.size(), 3);
+    EXPECT_TRUE(cache.contains(0));
+    EXPECT_TRUE(cache.contains(4));
+    EXPECT_TRUE(cache.contains(3));
+    EXPECT_FALSE(cache.contains(1));
+
+    cache.set_capacity(6);
+    for (int key = 10; key < 13; ++key) {
+        cache.put(key, key);
+    }
+    EXPECT_EQ(cache.size(), 6);
+    EXPECT_THROW(cache.set_capacity(size_t(1) << 40), std::invalid_argument);
+}
+
+TEST(LRUCacheTest, SetCapacitySegmented) {
+    LRUCache<int, int> cache(10, 0.5);
+    for (int key = 0; key < 10; ++key) {
+        cache.put(key, key);
+        cache.get(key); // All promoted; protected overflow is demoted
+    }
+    EXPECT_EQ(cache.protected_size(), 5);
+    cache.set_capacity(4);
+    EXPECT_EQ(cache.size(), 4);
+    EXPECT_EQ(cache.protected_size(), 2);
+    // The most recently hit keys survive
+    for (int key = 6; key < 10; ++key) {
+        EXPECT_TRUE(cache.contains(key)) << key;
+    }
+}
+
+TEST(LRUCacheTest, HitRatioAt) {
+    LRUCache<int, int> cache(100);
+    EXPECT_EQ(cache.hit_ratio_curve(), nullptr);
+    EXPECT_EQ(cache.hit_ratio_at(100), 0.0);
+    cache.track_hit_ratio(1000, 1.0);
+    // Cycling over 200 keys: LRU needs all 200 to hit at all
+    for (int round = 0; round < 50; ++round) {
+        for (int key = 0; key < 200; ++key) {
+            if (!cache.find(key)) cache.put(key, key);
+        }
+    }
+    EXPECT_LT(cache.hit_ratio_at(100), 0.05);
+    EXPECT_GT(cache.hit_ratio_at(200), 0.95);
+    ASSERT_NE(cache.hit_ratio_curve(), nullptr);
+    EXPECT_EQ(cache.hit_ratio_curve()->sampled(), 10000);
+}
+
+TEST(LRUCacheTest, AutoResizeFollowsWorkingSet) {
+    LRUCache<int, int> cache(100);
+    cache.track_hit_ratio(5000, 1.0);
+    cache.set_auto_resize(100, 5000, 0.01, 20000);
+    std::mt19937 rng(1);
+    auto run = [&](int keys, int requests) {
+        std::uniform_int_distribution<int> pick(0, keys - 1);
+        for (int i = 0; i < requests; ++i) {
+            int key = pick(rng);
+            if (!cache.find(key)) cache.put(key, key);
+        }
+    };
+    run(500, 100000);
+    EXPECT_GE(cache.capacity(), 400);
+    EXPECT_LE(cache.capacity(), 600);
+
+    // A larger working set pulls the capacity up once the curve has aged
+    run(2000, 400000);
+    EXPECT_GE(cache.capacity(), 1600);
+    EXPECT_LE(cache.capacity(), 2400);
+}
+
+TEST(LRUCacheTest, ShrinkIsIncremental) {
+    constexpr size_t step = LRUCache<int, int>::kShrinkStep;
+    LRUCache<int, int> cache(1000);
+    size_t evicted = 0;
+    cache.set_eviction_listener([&](const int&, int&) { ++evicted; });
+    for (int key = 0; key < 1000; ++key) {
+        cache.put(key, key);
+    }
+    cache.set_capacity(100);
+    EXPECT_EQ(evicted, step);
+    EXPECT_TRUE(cache.shrinking());
+
+    // Each request does a bounded share of the work; a new key evicts one
+    // more so the cache never grows while over capacity
+    for (int key = 1000; key < 1010; ++key) {
+        size_t before = evicted;
+        cache.put(key, key);
+        EXPECT_EQ(evicted - before, step + 1);
+    }
+    size_t before = evicted;
+    cache.get(999);
+    EXPECT_EQ(evicted - before, step);
+
+    while (cache.shrinking()) {
+        cache.shrink_step();
+    }
+    EXPECT_EQ(cache.size(), 100);
+    // The survivors are the most recently used
+    for (int key = 1009; key >= 1000; --key) {
+        EXPECT_TRUE(cache.contains(key)) << key;
+    }
+    EXPECT_TRUE(cache.contains(999));
+    EXPECT_FALSE(cache.contains(900));
+
+    // Growing back keeps everything and lets the cache fill again
+    cache.set_capacity(3000);
+    EXPECT_FALSE(cache.shrinking());
+    for (int key = 5000; key < 7900; ++key) {
+        cache.put(key, key);
+    }
+    EXPECT_EQ(cache.size(), 3000);
+    EXPECT_TRUE(cache.contains(999));
+}
+
+TEST(LRUCacheTest, BulkLoad) {
+    std::vector<int> keys;
+    std::vector<int> values;
+    for (int i = 0; i < 10000; ++i) {
+        keys.push_back(i);
+        values.push_back(i * 2);
+    }
+    LRUCache<int, int> cache(5000);
+    cache.put(-1, -1);
+    EXPECT_EQ(cache.bulk_load(keys, values, Recency::MostRecentFirst, 4), 5000);
+    EXPECT_FALSE(cache.contains(-1));
+    EXPECT_FALSE(cache.contains(5000));
+    int expected = 0;
+    for (auto [key, value] : cache) {
+        EXPECT_EQ(key, expected);
+        EXPECT_EQ(value, expected * 2);
+        ++expected;
+    }
+    EXPECT_EQ(expected, 5000);
+    cache.put(-1, -1); // Evicts the least recent loaded key
+    EXPECT_FALSE(cache.contains(4999));
+    EXPECT_EQ(cache.get(0), 0);
+
+    // Oldest first, with a repeated key: its latest copy wins
+    LRUCache<int, int> small(10);
+    EXPECT_EQ(small.bulk_load({ 1, 2, 1, 3 }, { 10, 20, 11, 30 }, Recency::LeastRecentFirst), 3);
+    std::vector<int> order;
+    for (auto [key, value] : small) {
+        order.push_back(key);
+    }
+    EXPECT_EQ(order, (std::vector<int>{ 3, 1, 2 }));
+    EXPECT_EQ(small.get(1), 11);
+    EXPECT_THROW(small.bulk_load({ 1, 2 }, { 1 }), std::invalid_argument);
+    EXPECT_EQ(small.bulk_load({}, {}), 0);
+    EXPECT_EQ(small.size(), 0);
+}
+
+TEST(LRUCacheTest, BulkLoadCapsOnDistinctKeys) {
+    // Key 1 repeats inside the first three; the cache still fills up
+    LRUCache<int, int> cache(3);
+    EXPECT_EQ(cache.bulk_load({ 1, 2, 1, 3, 4 }, { 10, 20, 11, 30, 40 }), 3);
+    std::vector<int> order;
+    for (auto [key, value] : cache) {
+        order.push_back(key);
+    }
+    EXPECT_EQ(order, (std::vector<int>{ 1, 2, 3 }));
+    EXPECT_EQ(cache.get(1), 10);
+
+    // Same result as putting the keys oldest first
+    std::vector<int> keys = { 5, 6, 5, 5, 7, 8, 6, 9 };
+    LRUCache<int, int> loaded(4);
+    LRUCache<int, int> replayed(4);
+    loaded.bulk_load(keys, keys, Recency::LeastRecentFirst);
+    for (int key : keys) {
+        replayed.put(key, key);
+    }
+    std::vector<int> loaded_order;
+    std::vector<int> replayed_order;
+    for (auto [key, value] : loaded) {
+        loaded_order.push_back(key);
+    }
+    for (auto [key, value] : replayed) {
+        replayed_order.push_back(key);
+    }
+    EXPECT_EQ(loaded_order, replayed_order);
+}
+
+TEST(LRUCacheTest, BulkLoadSegmented) {
+    LRUCache<int, int> cache(10, 0.5);
+    std::vector<int> keys = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+    EXPECT_EQ(cache.bulk_load(keys, keys), 10);
+    EXPECT_EQ(cache.protected_size(), 5);
+    cache.put(100, 100); // Probation tail goes first
+    EXPECT_FALSE(cache.contains(9));
+    EXPECT_TRUE(cache.contains(4));
+}
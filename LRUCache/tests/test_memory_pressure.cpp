@@ -0,0 +1,187 @@
+// tests/test_memory_pressure.cpp
+#include "../src/memory_pressure.hpp"
+#include "../src/lru.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace {
+
+// Scratch directory standing in for /sys/fs/cgroup or /proc
+class FakeDir {
+public:
+    explicit FakeDir(const std::string& name) : path_(testing::TempDir() + name) {
+        std::filesystem::remove_all(path_);
+        std::filesystem::create_directories(path_ + "/pressure");
+    }
+    ~FakeDir() { std::filesystem::remove_all(path_); }
+
+    void write(const std::string& file, const std::string& text) const {
+        std::ofstream(path_ + "/" + file) << text;
+    }
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+} // namespace
+
+TEST(MemoryPressureTest, ReadsCgroupFiles) {
+    FakeDir cgroup("mp_cgroup");
+    FakeDir proc("mp_proc");
+    cgroup.write("memory.current", "800\n");
+    cgroup.write("memory.max", "1000\n");
+    cgroup.write("memory.pressure", "some avg10=12.50 avg60=3.00 avg300=1.00 total=123\n"
+                                    "full avg10=2.00 avg60=0.50 avg300=0.10 total=45\n");
+    MemoryPressure reading = SystemMemorySource(cgroup.path(), proc.path())();
+    EXPECT_EQ(reading.used, 800);
+    EXPECT_EQ(reading.limit, 1000);
+    EXPECT_DOUBLE_EQ(reading.stall, 0.125);
+    EXPECT_DOUBLE_EQ(reading.usage(), 0.8);
+
+    // No cgroup limit: the machine's memory is the limit
+    proc.write("meminfo", "MemTotal:        4000 kB\nMemFree:  1000 kB\nMemAvailable:  3000 kB\n");
+    cgroup.write("memory.max", "max\n");
+    reading = SystemMemorySource(cgroup.path(), proc.path())();
+    EXPECT_EQ(reading.used, 800);
+    EXPECT_EQ(reading.limit, 4000 * 1024);
+}
+
+TEST(MemoryPressureTest, FallsBackToMeminfo) {
+    FakeDir proc("mp_proc_only");
+    proc.write("meminfo", "MemTotal:        4000 kB\nMemFree:  1000 kB\nMemAvailable:  1000 kB\n");
+    proc.write("pressure/memory", "some avg10=50.00 avg60=0.00 avg300=0.00 total=0\n");
+    MemoryPressure reading = SystemMemorySource(proc.path() + "/no_cgroup", proc.path())();
+    EXPECT_EQ(reading.used, 3000 * 1024);
+    EXPECT_EQ(reading.limit, 4000 * 1024);
+    EXPECT_DOUBLE_EQ(reading.stall, 0.5);
+
+    // Nothing to read: an empty reading, which is never pressure
+    reading = SystemMemorySource(proc.path() + "/none", proc.path() + "/none")();
+    EXPECT_EQ(reading.limit, 0);
+    MemoryPressureMonitor monitor([](size_t, const MemoryPressure&) { FAIL(); },
+                                  [] { return MemoryPressure{}; });
+    EXPECT_FALSE(monitor.poll());
+}
+
+TEST(MemoryPressureTest, PollAsksForTheExcess) {
+    MemoryPressure fake{ 850, 1000, 0.0 };
+    size_t asked = 0;
+    MemoryPressureMonitor monitor([&](size_t excess, const MemoryPressure&) { asked += excess; },
+                                  [&] { return fake; });
+    EXPECT_FALSE(monitor.poll()); // Between low and high
+    fake.used = 950;
+    EXPECT_TRUE(monitor.poll());
+    EXPECT_EQ(asked, 150); // Back down to low
+    EXPECT_TRUE(monitor.poll());
+    EXPECT_EQ(asked, 300); // Still over high: asked again
+    fake.used = 500;
+    fake.stall = 0.2;
+    EXPECT_TRUE(monitor.poll());
+    EXPECT_EQ(asked, 300); // Stalling under the limit: no excess, shed a share
+    EXPECT_EQ(monitor.triggers(), 3);
+    EXPECT_THROW(MemoryPressureMonitor([](size_t, const MemoryPressure&) {}, [] { return MemoryPressure{}; }, 0.5, 0.8),
+                 std::invalid_argument);
+}
+
+TEST(MemoryPressureTest, LingeringStallShedsOnce) {
+    LRUCache<int, int> cache(10000);
+    std::mutex mutex;
+    for (int i = 0; i < 10000; ++i) {
+        cache.put(i, i);
+    }
+    MemoryPressure fake{ 500, 1000, 0.15 };
+    MemoryPressureMonitor monitor(shed_from(cache, mutex, 0.1), [&] { return fake; });
+
+    // avg10 stays up for about 10 s after a short stall: 40 polls at the
+    // default interval shed once, and about a tenth of the cache
+    for (int i = 0; i < 40; ++i) {
+        monitor.poll();
+    }
+    EXPECT_EQ(monitor.triggers(), 1);
+    EXPECT_GT(cache.size(), 8500);
+    EXPECT_LT(cache.size(), 9500);
+
+    fake.stall = 0.2; // Worse, but by less than `stall`
+    EXPECT_FALSE(monitor.poll());
+    fake.stall = 0.3; // Another `stall` above the last trigger
+    EXPECT_TRUE(monitor.poll());
+    fake.stall = 0.05; // Passed, then back
+    EXPECT_FALSE(monitor.poll());
+    fake.stall = 0.15;
+    EXPECT_TRUE(monitor.poll());
+    EXPECT_EQ(monitor.triggers(), 3);
+    EXPECT_GT(cache.size(), 6000);
+}
+
+TEST(MemoryPressureTest, ReleaseMemoryEvictsTheTail) {
+    LRUCache<int, int> cache(100000);
+    for (int i = 0; i < 100000; ++i) {
+        cache.put(i, i);
+    }
+    size_t full = cache.memory_usage();
+    size_t evicted = cache.release_memory(full / 2);
+    EXPECT_NEAR(static_cast<double>(evicted), 50000.0, 1000.0);
+    EXPECT_EQ(cache.size(), 100000 - evicted);
+    EXPECT_LT(cache.memory_usage(), full * 3 / 4);
+    EXPECT_FALSE(cache.contains(0));
+    EXPECT_TRUE(cache.contains(99999));
+    EXPECT_EQ(cache.capacity(), 100000);
+
+    EXPECT_EQ(cache.evict_to(10), 100000 - evicted - 10);
+    EXPECT_EQ(cache.size(), 10);
+    cache.shrink_to_fit();
+    EXPECT_LT(cache.memory_usage(), 1024);
+    for (int i = 99990; i < 100000; ++i) {
+        EXPECT_EQ(cache.get(i), i);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        cache.put(i, i);
+    }
+    EXPECT_EQ(cache.size(), 1010);
+}
+
+TEST(MemoryPressureTest, MonitorShedsCache) {
+    LRUCache<int, int> cache(50000);
+    std::mutex mutex;
+    for (int i = 0; i < 50000; ++i) {
+        cache.put(i, i);
+    }
+    // Pretend the cache is all of the container's memory, with a limit
+    // just below its current size
+    size_t limit = cache.memory_usage() * 21 / 20;
+    auto source = [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return MemoryPressure{ cache.memory_usage(), limit, 0.0 };
+    };
+    MemoryPressureMonitor monitor(shed_from(cache, mutex), source);
+    EXPECT_TRUE(monitor.poll());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        EXPECT_LT(cache.size(), 50000);
+        EXPECT_LE(cache.memory_usage(), limit * 9 / 10);
+        EXPECT_TRUE(cache.contains(49999));
+    }
+    EXPECT_FALSE(monitor.poll()); // Back under high
+
+    // The background thread polls the same way
+    limit = limit / 2;
+    monitor.start(std::chrono::milliseconds(1));
+    EXPECT_TRUE(monitor.running());
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (monitor.triggers() < 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    monitor.stop();
+    EXPECT_FALSE(monitor.running());
+    EXPECT_GE(monitor.triggers(), 2);
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_LE(cache.memory_usage(), limit);
+}
@@ -0,0 +1,83 @@
+// tests/test_mrc.cpp
+#include "../src/mrc.hpp"
+#include "../src/lru.hpp"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Skewed request stream over `keys` keys: low ranks are requested far more
+std::vector<uint64_t> skewed_stream(size_t keys, size_t requests, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<uint64_t> stream(requests);
+    for (uint64_t& key : stream) {
+        key = static_cast<uint64_t>(static_cast<double>(keys) * std::pow(uniform(rng), 3.0));
+    }
+    return stream;
+}
+
+double exact_hit_ratio(const std::vector<uint64_t>& stream, size_t capacity) {
+    LRUCache<uint64_t, uint64_t> cache(capacity);
+    size_t hits = 0;
+    for (uint64_t key : stream) {
+        if (cache.find(key)) {
+            ++hits;
+        }
+        else {
+            cache.put(key, key);
+        }
+    }
+    return static_cast<double>(hits) / static_cast<double>(stream.size());
+}
+
+} // namespace
+
+TEST(MissRatioCurveTest, ExactWhenSamplingEverything) {
+    MissRatioCurve<int> curve(8, 1.0, 8);
+    // Cyclic pattern over 4 keys: every repeat has stack distance 3
+    for (int round = 0; round < 100; ++round) {
+        for (int key = 0; key < 4; ++key) {
+            curve.access(key);
+        }
+    }
+    EXPECT_EQ(curve.sampled(), 400);
+    EXPECT_EQ(curve.sampled_keys(), 4);
+    EXPECT_DOUBLE_EQ(curve.hit_ratio(3), 0.0);   // LRU thrashes below 4
+    EXPECT_DOUBLE_EQ(curve.hit_ratio(4), 0.99);  // Only first requests miss
+    EXPECT_NEAR(curve.miss_ratio(8), 0.01, 1e-12);
+}
+
+TEST(MissRatioCurveTest, TracksExactLRUCurve) {
+    std::vector<uint64_t> stream = skewed_stream(100000, 1000000, 7);
+    MissRatioCurve<uint64_t> curve(50000, 0.1);
+    for (uint64_t key : stream) {
+        curve.access(key);
+    }
+    EXPECT_LT(curve.sampled_keys(), 100000 * 0.1 * 1.2);
+    for (size_t capacity : { 1000, 5000, 20000, 50000 }) {
+        double exact = exact_hit_ratio(stream, capacity);
+        EXPECT_NEAR(curve.hit_ratio(capacity), exact, 0.03) << capacity;
+    }
+    // Monotone in capacity
+    for (size_t capacity = 0; capacity < 50000; capacity += 1000) {
+        EXPECT_LE(curve.hit_ratio(capacity), curve.hit_ratio(capacity + 1000));
+    }
+}
+
+TEST(MissRatioCurveTest, AgeAndClear) {
+    MissRatioCurve<int> curve(100, 1.0, 100);
+    for (int i = 0; i < 1000; ++i) {
+        curve.access(i % 10);
+    }
+    double before = curve.hit_ratio(10);
+    curve.age();
+    EXPECT_DOUBLE_EQ(curve.hit_ratio(10), before); // Same shape, half the weight
+    curve.clear();
+    EXPECT_EQ(curve.hit_ratio(10), 0.0);
+    EXPECT_EQ(curve.sampled(), 0);
+    EXPECT_THROW(MissRatioCurve<int>(100, 0.0), std::invalid_argument);
+}
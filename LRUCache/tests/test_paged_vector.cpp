@@ -0,0 +1,73 @@
+// tests/test_paged_vector.cpp
+#include "../src/paged_vector.hpp"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+TEST(PagedVectorTest, PushAndIndex) {
+    PagedVector<std::string> values;
+    for (int i = 0; i < 10000; ++i) {
+        values.push_back(std::to_string(i));
+    }
+    ASSERT_EQ(values.size(), 10000);
+    for (int i = 0; i < 10000; ++i) {
+        EXPECT_EQ(values[i], std::to_string(i));
+    }
+    EXPECT_EQ(values.back(), "9999");
+}
+
+TEST(PagedVectorTest, FullPagesNeverMove) {
+    PagedVector<int> values;
+    for (size_t i = 0; i < PagedVector<int>::kPageSize; ++i) {
+        values.push_back(static_cast<int>(i));
+    }
+    int* first = &values[0];
+    for (size_t i = 0; i < 5 * PagedVector<int>::kPageSize; ++i) {
+        values.push_back(0);
+    }
+    EXPECT_EQ(&values[0], first);
+    EXPECT_EQ(values.capacity(), 6 * PagedVector<int>::kPageSize);
+}
+
+TEST(PagedVectorTest, ReserveFitsSmallCountsExactly) {
+    PagedVector<int> values;
+    values.reserve(100);
+    EXPECT_EQ(values.capacity(), 100);
+    values.reserve(PagedVector<int>::kPageSize + 1);
+    EXPECT_EQ(values.capacity(), 2 * PagedVector<int>::kPageSize);
+}
+
+TEST(PagedVectorTest, PopAndClearDestroyElements) {
+    auto tracker = std::make_shared<int>(0);
+    PagedVector<std::shared_ptr<int>> values;
+    for (int i = 0; i < 5000; ++i) {
+        values.push_back(tracker);
+    }
+    values.pop_back();
+    EXPECT_EQ(tracker.use_count(), 5000);
+    values.clear();
+    EXPECT_EQ(tracker.use_count(), 1);
+    EXPECT_TRUE(values.empty());
+}
+
+TEST(PagedVectorTest, ShrinkToFitFreesTrailingPages) {
+    PagedVector<int> values;
+    for (size_t i = 0; i < 3 * PagedVector<int>::kPageSize; ++i) {
+        values.push_back(static_cast<int>(i));
+    }
+    while (values.size() > 10) {
+        values.pop_back();
+    }
+    values.shrink_to_fit();
+    EXPECT_EQ(values.capacity(), 10);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(values[i], i);
+    }
+    values.push_back(10);
+    EXPECT_EQ(values[10], 10);
+
+    values.clear();
+    values.shrink_to_fit();
+    EXPECT_EQ(values.capacity(), 0);
+    EXPECT_EQ(values.memory_usage(), 0);
+}
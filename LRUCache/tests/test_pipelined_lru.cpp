@@ -0,0 +1,110 @@
+// tests/test_pipelined_lru.cpp
+#include "../src/pipelined_lru.hpp"
+#include <gtest/gtest.h>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(PipelinedLRUCacheTest, GetPutErase) {
+    PipelinedLRUCache<int, std::string> cache(4, 1000);
+    auto client = cache.connect();
+    client.put(1, "one");
+    client.put(2, "two");
+    EXPECT_EQ(client.get(1), "one"); // Sees its own earlier put
+    EXPECT_EQ(client.get(3), std::nullopt);
+    client.put(1, "uno");
+    client.erase(2);
+    std::vector<std::optional<std::string>> results = client.get_many({ 1, 2, 3 });
+    ASSERT_EQ(results.size(), 3);
+    EXPECT_EQ(results[0], "uno");
+    EXPECT_EQ(results[1], std::nullopt);
+    EXPECT_EQ(results[2], std::nullopt);
+    EXPECT_EQ(cache.size(), 1);
+    EXPECT_EQ(cache.shards(), 4);
+}
+
+TEST(PipelinedLRUCacheTest, EachShardEvictsItsOwnTail) {
+    PipelinedLRUCache<int, int> cache(4, 400);
+    auto client = cache.connect();
+    std::vector<int> keys;
+    for (int i = 0; i < 10000; ++i) {
+        client.put(i, i);
+        keys.push_back(i);
+    }
+    // More lookups than a queue holds: get_many must interleave collecting
+    std::vector<std::optional<int>> results = client.get_many(keys);
+    size_t hits = 0;
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (results[i]) {
+            EXPECT_EQ(*results[i], static_cast<int>(i));
+            ++hits;
+        }
+    }
+    EXPECT_LE(hits, 400);
+    EXPECT_GT(hits, 300);
+    EXPECT_LE(cache.size(), 400);
+    EXPECT_EQ(client.get(9999), 9999); // Most recent keys survive
+    EXPECT_EQ(client.get(0), std::nullopt);
+}
+
+TEST(PipelinedLRUCacheTest, ShardsHoldCapacityInTotal) {
+    // 10 does not divide by 4: two shards hold 3 entries and two hold 2
+    PipelinedLRUCache<int, int> cache(4, 10);
+    auto client = cache.connect();
+    std::vector<int> keys;
+    for (int i = 0; i < 1000; ++i) {
+        client.put(i, i);
+        keys.push_back(i);
+    }
+    // Every owner answers a get, so each has published its size
+    client.get_many(keys);
+    EXPECT_EQ(cache.size(), 10);
+}
+
+TEST(PipelinedLRUCacheTest, ManyClients) {
+    constexpr int kThreads = 4;
+    constexpr int kKeys = 20000;
+    PipelinedLRUCache<int, int> cache(3, 2 * kThreads * kKeys); // Room for an uneven split
+    std::vector<std::thread> threads;
+    std::vector<int> mismatches(kThreads, 0);
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            auto client = cache.connect();
+            std::vector<int> keys;
+            for (int i = 0; i < kKeys; ++i) {
+                client.put(t * kKeys + i, i);
+                keys.push_back(t * kKeys + i);
+            }
+            std::vector<std::optional<int>> results = client.get_many(keys);
+            for (int i = 0; i < kKeys; ++i) {
+                if (results[i] != i) {
+                    ++mismatches[t];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int t = 0; t < kThreads; ++t) {
+        EXPECT_EQ(mismatches[t], 0) << t;
+    }
+    EXPECT_EQ(cache.connect().get(0), 0);
+    EXPECT_EQ(cache.size(), kThreads * kKeys);
+}
+
+TEST(PipelinedLRUCacheTest, ClientSlotsAreReused) {
+    PipelinedLRUCache<int, int> cache(2, 100, 2, true);
+    auto a = cache.connect();
+    {
+        auto b = cache.connect();
+        b.put(7, 70);
+        EXPECT_THROW(cache.connect(), std::runtime_error);
+    }
+    auto c = cache.connect();
+    EXPECT_EQ(c.get(7), 70);
+    auto moved = std::move(a);
+    EXPECT_EQ(moved.get(7), 70);
+    EXPECT_THROW((PipelinedLRUCache<int, int>(0, 100)), std::invalid_argument);
+}
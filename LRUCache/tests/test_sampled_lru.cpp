@@ -0,0 +1,89 @@
+// tests/test_sampled_lru.cpp
+#include "../src/sampled_lru.hpp"
+#include "../src/lru.hpp"
+#include <gtest/gtest.h>
+#include <string>
+
+TEST(SampledLRUCacheTest, StoreAndRetrieve) {
+    SampledLRUCache<int, std::string> cache(2);
+    cache.put(1, "One");
+    cache.put(2, "Two");
+    EXPECT_EQ(cache.get(1), "One");
+    EXPECT_EQ(cache.get(2), "Two");
+
+    cache.put(3, "Three");
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_EQ(cache.get(3), "Three");
+    EXPECT_THROW(cache.get(4), std::runtime_error);
+    EXPECT_EQ(cache.find(4), nullptr);
+}
+
+TEST(SampledLRUCacheTest, UpdateExistingKey) {
+    SampledLRUCache<int, int> cache(3);
+    cache.put(1, 10);
+    cache.put(1, 11);
+    EXPECT_EQ(cache.size(), 1);
+    EXPECT_EQ(cache.get(1), 11);
+}
+
+TEST(SampledLRUCacheTest, ZeroCapacity) {
+    SampledLRUCache<int, int> cache(0);
+    cache.put(1, 1);
+    EXPECT_FALSE(cache.contains(1));
+    EXPECT_THROW((SampledLRUCache<int, int>(10, 0)), std::invalid_argument);
+}
+
+TEST(SampledLRUCacheTest, ApproximatesLRU) {
+    // Keep the first half hot, then replace the other half; exact LRU
+    // keeps all 500 hot keys
+    auto hot_kept = [](size_t samples) {
+        SampledLRUCache<int, int> cache(1000, samples);
+        for (int key = 0; key < 1000; ++key) {
+            cache.put(key, key);
+        }
+        for (int key = 0; key < 500; ++key) {
+            cache.get(key);
+        }
+        for (int key = 1000; key < 1500; ++key) {
+            cache.put(key, key);
+        }
+        EXPECT_EQ(cache.size(), 1000);
+        int kept = 0;
+        for (int key = 0; key < 500; ++key) {
+            kept += cache.contains(key);
+        }
+        return kept;
+    };
+    int five = hot_kept(5);
+    int ten = hot_kept(10);
+    EXPECT_GE(five, 400);
+    EXPECT_GE(ten, 450);
+    EXPECT_GE(ten, five); // More samples, closer to LRU
+}
+
+TEST(SampledLRUCacheTest, ChurnKeepsStampsInSync) {
+    SampledLRUCache<int, int> cache(64, 3);
+    for (int i = 0; i < 20000; ++i) {
+        cache.put((i * 37) % 501, i);
+        if (i % 3 == 0) cache.find((i * 11) % 100);
+    }
+    EXPECT_EQ(cache.size(), 64);
+    int present = 0;
+    for (int key = 0; key < 501; ++key) {
+        present += cache.contains(key);
+    }
+    EXPECT_EQ(present, 64);
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(SampledLRUCacheTest, SmallerThanListedCache) {
+    SampledLRUCache<uint64_t, uint64_t> sampled(1000);
+    LRUCache<uint64_t, uint64_t> listed(1000);
+    for (uint64_t i = 0; i < 1000; ++i) {
+        sampled.put(i, i);
+        listed.put(i, i);
+    }
+    // 4-byte stamps instead of two 4-byte links, without padding
+    EXPECT_LT(sampled.memory_usage() + 1000 * 3, listed.memory_usage());
+}
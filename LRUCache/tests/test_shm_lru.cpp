@@ -0,0 +1,191 @@
+// tests/test_shm_lru.cpp
+#include "../src/shm_lru.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+// Anonymous shared mapping, inherited across fork()
+struct SharedRegion {
+    void* addr;
+    size_t bytes;
+    explicit SharedRegion(size_t size) : bytes(size) {
+        addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    }
+    ~SharedRegion() { munmap(addr, bytes); }
+};
+
+// Hashing a negative key kills the process, which then dies holding the
+// cache's lock
+struct FatalKey {
+    int id;
+    bool operator==(const FatalKey& other) const { return id == other.id; }
+};
+
+} // namespace
+
+template <>
+struct std::hash<FatalKey> {
+    size_t operator()(const FatalKey& key) const {
+        if (key.id < 0) {
+            _exit(0);
+        }
+        return static_cast<size_t>(key.id);
+    }
+};
+
+TEST(SharedLRUCacheTest, StoreAndRetrieve) {
+    std::vector<char> region(SharedLRUCache<int, double>::required_size(2));
+    auto cache = SharedLRUCache<int, double>::format(region.data(), region.size(), 2);
+
+    cache.put(1, 1.5);
+    cache.put(2, 2.5);
+    EXPECT_EQ(cache.get(1), 1.5);
+    EXPECT_EQ(cache.get(2), 2.5);
+    EXPECT_EQ(cache.size(), 2);
+
+    // Key 1 is now the LRU entry
+    cache.put(3, 3.5);
+    EXPECT_THROW(cache.get(1), std::runtime_error);
+    EXPECT_EQ(cache.get(3), 3.5);
+    EXPECT_EQ(cache.size(), 2);
+}
+
+TEST(SharedLRUCacheTest, UpdateAndRecency) {
+    std::vector<char> region(SharedLRUCache<int, int>::required_size(3));
+    auto cache = SharedLRUCache<int, int>::format(region.data(), region.size(), 3);
+
+    cache.put(1, 10);
+    cache.put(2, 20);
+    cache.put(3, 30);
+    cache.put(1, 11); // Update moves 1 to the front
+    cache.put(4, 40); // Evicts 2
+
+    EXPECT_FALSE(cache.contains(2));
+    EXPECT_EQ(cache.get(1), 11);
+    EXPECT_TRUE(cache.contains(3));
+    EXPECT_TRUE(cache.contains(4));
+}
+
+TEST(SharedLRUCacheTest, ManyEvictionsReuseSlots) {
+    std::vector<char> region(SharedLRUCache<int, int>::required_size(8));
+    auto cache = SharedLRUCache<int, int>::format(region.data(), region.size(), 8);
+
+    for (int i = 0; i < 1000; ++i) {
+        cache.put(i, i * 3);
+    }
+    EXPECT_EQ(cache.size(), 8);
+    for (int i = 992; i < 1000; ++i) {
+        EXPECT_EQ(cache.get(i), i * 3);
+    }
+    EXPECT_FALSE(cache.contains(991));
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_FALSE(cache.contains(999));
+}
+
+TEST(SharedLRUCacheTest, AttachSeesSameData) {
+    std::vector<char> region(SharedLRUCache<int, int>::required_size(4));
+    auto writer = SharedLRUCache<int, int>::format(region.data(), region.size(), 4);
+    auto reader = SharedLRUCache<int, int>::attach(region.data(), region.size());
+
+    writer.put(7, 70);
+    EXPECT_EQ(reader.get(7), 70);
+    EXPECT_EQ(reader.capacity(), 4);
+}
+
+TEST(SharedLRUCacheTest, AttachRejectsBadRegions) {
+    std::vector<char> region(SharedLRUCache<int, int>::required_size(4));
+    EXPECT_THROW((SharedLRUCache<int, int>::attach(region.data(), region.size())), std::runtime_error);
+
+    SharedLRUCache<int, int>::format(region.data(), region.size(), 4);
+    EXPECT_THROW((SharedLRUCache<int, double>::attach(region.data(), region.size())), std::runtime_error);
+    EXPECT_THROW((SharedLRUCache<int, int>::format(region.data(), 16, 4)), std::invalid_argument);
+}
+
+TEST(SharedLRUCacheTest, SharedAcrossProcesses) {
+    using Cache = SharedLRUCache<int, int>;
+    SharedRegion region(Cache::required_size(64));
+    ASSERT_NE(region.addr, MAP_FAILED);
+    auto cache = Cache::format(region.addr, region.bytes, 64);
+
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        auto child = Cache::attach(region.addr, region.bytes);
+        for (int i = 0; i < 32; ++i) {
+            child.put(i, i * i);
+        }
+        _exit(0);
+    }
+
+    // Both processes write at the same time
+    for (int i = 100; i < 132; ++i) {
+        cache.put(i, -i);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    ASSERT_TRUE(WIFEXITED(status));
+
+    EXPECT_EQ(cache.size(), 64);
+    EXPECT_EQ(cache.get(5), 25);
+    EXPECT_EQ(cache.get(31), 961);
+    EXPECT_EQ(cache.get(120), -120);
+}
+
+TEST(SharedLRUCacheTest, RecoversFromDeadLockOwner) {
+#if !SHM_LRU_ROBUST_LOCK
+    GTEST_SKIP() << "No robust process-shared mutexes on this platform";
+#endif
+    using Cache = SharedLRUCache<FatalKey, int>;
+    SharedRegion region(Cache::required_size(16));
+    ASSERT_NE(region.addr, MAP_FAILED);
+    auto cache = Cache::format(region.addr, region.bytes, 16);
+    cache.put(FatalKey{ 1 }, 1);
+
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        auto child = Cache::attach(region.addr, region.bytes);
+        child.put(FatalKey{ -1 }, 0); // Exits inside the lock
+        _exit(1);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+
+    // The next locker takes over and starts from an empty cache
+    EXPECT_EQ(cache.size(), 0);
+    cache.put(FatalKey{ 2 }, 2);
+    EXPECT_EQ(cache.get(FatalKey{ 2 }), 2);
+    EXPECT_FALSE(cache.contains(FatalKey{ 1 }));
+}
+
+TEST(SharedLRUCacheTest, NamedSharedMemory) {
+    const std::string name = "/lru_test_" + std::to_string(getpid());
+    SharedLRUCache<int, int>::remove(name);
+
+    try {
+        // A rejected capacity leaves the name free
+        EXPECT_THROW((SharedLRUCache<int, int>::create(name, 0)), std::invalid_argument);
+        auto owner = SharedLRUCache<int, int>::create(name, 16);
+        owner.put(1, 100);
+
+        auto other = SharedLRUCache<int, int>::open(name);
+        EXPECT_EQ(other.get(1), 100);
+        other.put(2, 200);
+        EXPECT_EQ(owner.get(2), 200);
+    }
+    catch (const std::runtime_error& e) {
+        SharedLRUCache<int, int>::remove(name);
+        GTEST_SKIP() << e.what();
+    }
+    SharedLRUCache<int, int>::remove(name);
+    EXPECT_THROW((SharedLRUCache<int, int>::open(name)), std::runtime_error);
+}
@@ -0,0 +1,242 @@
+// tests/test_snapshot.cpp
+#include "../src/lru.hpp"
+#include "../src/lru_debug.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+namespace {
+
+// Removes the snapshot file when the test finishes
+struct TempPath {
+    std::string path;
+    explicit TempPath(const std::string& name) : path(testing::TempDir() + name) {}
+    ~TempPath() { std::remove(path.c_str()); }
+};
+
+struct Point {
+    std::string label;
+    int x;
+};
+
+// Example of a serializer for a type that is not trivially copyable
+struct PointSerializer {
+    static constexpr uint32_t format = 0x504f4e54;
+
+    static void write(std::ostream& out, const Point& p) {
+        SnapshotSerializer<std::string>::write(out, p.label);
+        SnapshotSerializer<int>::write(out, p.x);
+    }
+
+    static Point read(SnapshotReader& in) {
+        Point p;
+        p.label = SnapshotSerializer<std::string>::read(in);
+        p.x = SnapshotSerializer<int>::read(in);
+        return p;
+    }
+};
+
+} // namespace
+
+TEST(SnapshotTest, RoundTripTriviallyCopyable) {
+    TempPath file("lru_trivial.snap");
+    LRUCache<int, double> cache(4);
+    cache.put(1, 1.5);
+    cache.put(2, 2.5);
+    cache.put(3, 3.5);
+    cache.save(file.path);
+
+    LRUCache<int, double> restored(4);
+    EXPECT_EQ(restored.load(file.path), 3);
+    EXPECT_EQ(restored.size(), 3);
+    EXPECT_EQ(restored.get(1), 1.5);
+    EXPECT_EQ(restored.get(2), 2.5);
+    EXPECT_EQ(restored.get(3), 3.5);
+}
+
+TEST(SnapshotTest, PreservesRecencyOrder) {
+    TempPath file("lru_order.snap");
+    LRUCache<int, std::string> cache(3);
+    cache.put(1, "One");
+    cache.put(2, "Two");
+    cache.put(3, "Three");
+    cache.get(1); // Order is now 1, 3, 2
+    cache.save(file.path);
+
+    LRUCache<int, std::string> restored(3);
+    restored.load(file.path);
+
+    testing::internal::CaptureStdout();
+    display(restored);
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), "1: One -> 3: Three -> 2: Two -> NULL\n");
+
+    // The LRU entry is still the first to go
+    restored.put(4, "Four");
+    EXPECT_FALSE(restored.contains(2));
+}
+
+TEST(SnapshotTest, LoadKeepsHottestWhenCapacityIsSmaller) {
+    TempPath file("lru_truncate.snap");
+    LRUCache<int, int> cache(5);
+    for (int i = 1; i <= 5; ++i) {
+        cache.put(i, i * 10);
+    }
+    cache.save(file.path);
+
+    LRUCache<int, int> restored(2);
+    EXPECT_EQ(restored.load(file.path), 2);
+    EXPECT_TRUE(restored.contains(5));
+    EXPECT_TRUE(restored.contains(4));
+    EXPECT_FALSE(restored.contains(3));
+}
+
+TEST(SnapshotTest, LoadReplacesExistingContents) {
+    TempPath file("lru_replace.snap");
+    LRUCache<int, int> cache(3);
+    cache.put(1, 100);
+    cache.save(file.path);
+
+    LRUCache<int, int> restored(3);
+    restored.put(7, 700);
+    restored.load(file.path);
+    EXPECT_EQ(restored.size(), 1);
+    EXPECT_FALSE(restored.contains(7));
+    EXPECT_EQ(restored.get(1), 100);
+}
+
+TEST(SnapshotTest, EmptyCache) {
+    TempPath file("lru_empty.snap");
+    LRUCache<int, int> cache(3);
+    cache.save(file.path);
+
+    LRUCache<int, int> restored(3);
+    EXPECT_EQ(restored.load(file.path), 0);
+    EXPECT_EQ(restored.size(), 0);
+}
+
+TEST(SnapshotTest, CustomSerializer) {
+    TempPath file("lru_custom.snap");
+    LRUCache<int, Point> cache(2);
+    cache.put(1, { "origin", 0 });
+    cache.put(2, { "right", 5 });
+    cache.save<SnapshotSerializer<int>, PointSerializer>(file.path);
+
+    LRUCache<int, Point> restored(2);
+    restored.load<SnapshotSerializer<int>, PointSerializer>(file.path);
+    Point p = restored.get(2);
+    EXPECT_EQ(p.label, "right");
+    EXPECT_EQ(p.x, 5);
+}
+
+TEST(SnapshotTest, SkipsStaleEntries) {
+    TempPath file("lru_stale.snap");
+    LRUCache<int, int> cache(4);
+    cache.put(1, 1, 3);
+    cache.put(2, 2);
+    cache.put(3, 3, 3);
+    cache.invalidate_tag(3);
+    cache.save(file.path);
+
+    LRUCache<int, int> restored(4);
+    EXPECT_EQ(restored.load(file.path), 1);
+    EXPECT_EQ(restored.size(), 1);
+    EXPECT_EQ(restored.get(2), 2);
+    EXPECT_FALSE(restored.contains(1));
+}
+
+TEST(SnapshotTest, RejectsMismatchedTypes) {
+    TempPath file("lru_mismatch.snap");
+    LRUCache<int, int> cache(2);
+    cache.put(1, 1);
+    cache.save(file.path);
+
+    LRUCache<int, std::string> restored(2);
+    EXPECT_THROW(restored.load(file.path), std::runtime_error);
+}
+
+TEST(SnapshotTest, RejectsTruncatedFile) {
+    TempPath file("lru_truncated.snap");
+    LRUCache<int, std::string> cache(2);
+    cache.put(1, "a fairly long value");
+    cache.save(file.path);
+
+    // Chop off the end of the last value
+    std::string bytes;
+    {
+        std::ifstream in(file.path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream out(file.path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 4));
+    }
+
+    LRUCache<int, std::string> restored(2);
+    EXPECT_THROW(restored.load(file.path), std::runtime_error);
+}
+
+TEST(SnapshotTest, TruncatedFileKeepsCurrentContents) {
+    TempPath file("lru_truncated_keep.snap");
+    LRUCache<int, std::string> cache(3);
+    cache.put(1, "One");
+    cache.put(2, "a fairly long value");
+    cache.put(3, "Three");
+    cache.save(file.path);
+
+    // Cut the file inside the last entry, after the others decode fine
+    std::string bytes;
+    {
+        std::ifstream in(file.path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream out(file.path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 2));
+    }
+
+    LRUCache<int, std::string> restored(3);
+    restored.put(7, "Seven");
+    restored.put(8, "Eight");
+    EXPECT_THROW(restored.load(file.path), std::runtime_error);
+    EXPECT_EQ(restored.size(), 2);
+    EXPECT_EQ(restored.get(7), "Seven");
+    EXPECT_EQ(restored.get(8), "Eight");
+    EXPECT_FALSE(restored.contains(3));
+}
+
+TEST(SnapshotTest, FailedSaveKeepsPreviousSnapshot) {
+    TempPath file("lru_failed_save.snap");
+    LRUCache<int, int> cache(2);
+    cache.put(1, 10);
+    cache.save(file.path);
+
+    // A directory in the way of the temporary file makes the next save fail
+    std::string temp_path = file.path + ".tmp";
+    ASSERT_TRUE(std::filesystem::create_directory(temp_path));
+    cache.put(2, 20);
+    EXPECT_THROW(cache.save(file.path), std::runtime_error);
+    std::filesystem::remove(temp_path);
+
+    LRUCache<int, int> restored(2);
+    EXPECT_EQ(restored.load(file.path), 1);
+    EXPECT_EQ(restored.get(1), 10);
+}
+
+TEST(SnapshotTest, SaveReplacesFileAndLeavesNoTemporary) {
+    TempPath file("lru_replace.snap");
+    LRUCache<int, int> cache(2);
+    cache.put(1, 10);
+    cache.save(file.path);
+    cache.put(2, 20);
+    cache.save(file.path);
+
+    EXPECT_FALSE(std::ifstream(file.path + ".tmp").good());
+    LRUCache<int, int> restored(2);
+    EXPECT_EQ(restored.load(file.path), 2);
+}
+
+TEST(SnapshotTest, MissingFile) {
+    LRUCache<int, int> cache(2);
+    EXPECT_THROW(cache.load(testing::TempDir() + "does_not_exist.snap"), std::runtime_error);
+}
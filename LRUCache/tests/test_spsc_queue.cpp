@@ -0,0 +1,60 @@
+// tests/test_spsc_queue.cpp
+#include "../src/spsc_queue.hpp"
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+
+TEST(SpscQueueTest, FifoAndBounded) {
+    SpscQueue<int> queue(5);
+    EXPECT_EQ(queue.capacity(), 8);
+    EXPECT_TRUE(queue.empty());
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_TRUE(queue.try_push(i));
+    }
+    EXPECT_FALSE(queue.try_push(8));
+    EXPECT_EQ(queue.size(), 8);
+    int value = -1;
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(queue.try_pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.try_pop(value));
+    EXPECT_TRUE(queue.try_push(9)); // Wraps around
+    ASSERT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(value, 9);
+}
+
+TEST(SpscQueueTest, FailedPushKeepsTheValue) {
+    SpscQueue<std::unique_ptr<int>> queue(2);
+    EXPECT_TRUE(queue.try_push(std::make_unique<int>(1)));
+    EXPECT_TRUE(queue.try_push(std::make_unique<int>(2)));
+    auto third = std::make_unique<int>(3);
+    EXPECT_FALSE(queue.try_push(std::move(third)));
+    ASSERT_NE(third, nullptr);
+    EXPECT_EQ(*third, 3);
+}
+
+TEST(SpscQueueTest, TransfersAcrossThreads) {
+    constexpr uint64_t kCount = 100000;
+    SpscQueue<uint64_t> queue(64);
+    std::thread producer([&] {
+        for (uint64_t i = 0; i < kCount; ++i) {
+            while (!queue.try_push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    uint64_t expected = 0;
+    uint64_t value = 0;
+    while (expected < kCount) {
+        if (queue.try_pop(value)) {
+            ASSERT_EQ(value, expected);
+            ++expected;
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(queue.empty());
+}
@@ -0,0 +1,130 @@
+// tests/test_static_lru.cpp
+#include "../src/static_lru.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Mirrors LRUCacheTest.EvictionPolicy, evaluated at compile time
+template <size_t N>
+constexpr int evict_least_recent() {
+    StaticLRUCache<int, int, N> cache;
+    for (int i = 1; i <= static_cast<int>(N); ++i) {
+        cache.put(i, i * 10);
+    }
+    cache.get(1);             // 2 is now the LRU entry
+    cache.put(1000, 1);       // Evicts 2
+    if (cache.contains(2) || !cache.contains(1000) || cache.size() != N) return -1;
+    return cache.get(1);
+}
+
+template <typename Cache>
+std::vector<int> keys_in_order(const Cache& cache) {
+    std::vector<int> keys;
+    cache.for_each([&](const auto& key, const auto&) { keys.push_back(key); });
+    return keys;
+}
+
+} // namespace
+
+static_assert(evict_least_recent<4>() == 10, "linear-scan cache works in constant expressions");
+static_assert(evict_least_recent<64>() == 10, "indexed cache works in constant expressions");
+
+static_assert(std::is_same_v<StaticLRUCache<int, int, 8>::link_type, uint8_t>);
+static_assert(std::is_same_v<StaticLRUCache<int, int, 256>::link_type, uint16_t>);
+static_assert(std::is_same_v<StaticLRUCache<int, int, 70000>::link_type, uint32_t>);
+static_assert(!StaticLRUCache<int, int, 16>::uses_index);
+static_assert(StaticLRUCache<int, int, 17>::index_size == 64);
+
+TEST(StaticLRUCacheTest, StoreAndRetrieve) {
+    StaticLRUCache<int, std::string, 2> cache;
+
+    cache.put(1, "One");
+    EXPECT_EQ(cache.get(1), "One");
+    cache.put(2, "Two");
+    EXPECT_EQ(cache.get(2), "Two");
+
+    cache.put(3, "Three");
+    EXPECT_THROW(cache.get(1), std::runtime_error);
+    EXPECT_EQ(cache.get(2), "Two");
+    EXPECT_EQ(cache.get(3), "Three");
+}
+
+TEST(StaticLRUCacheTest, UpdateExistingKey) {
+    StaticLRUCache<int, int, 3> cache;
+    cache.put(1, 10);
+    cache.put(2, 20);
+    cache.put(1, 11);
+
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_EQ(keys_in_order(cache), (std::vector<int>{ 1, 2 }));
+    EXPECT_EQ(cache.get(1), 11);
+}
+
+TEST(StaticLRUCacheTest, FindTouchesEntry) {
+    StaticLRUCache<int, int, 2> cache;
+    EXPECT_EQ(cache.find(1), nullptr);
+    cache.put(1, 10);
+    cache.put(2, 20);
+
+    ASSERT_NE(cache.find(1), nullptr);
+    cache.put(3, 30);
+    EXPECT_FALSE(cache.contains(2));
+    EXPECT_TRUE(cache.contains(1));
+}
+
+TEST(StaticLRUCacheTest, LinearScanMatchesEveryLane) {
+    // Each key lands in a different SIMD lane (and the scalar tail)
+    StaticLRUCache<uint64_t, int, 15> wide;
+    StaticLRUCache<uint32_t, int, 15> narrow;
+    for (int i = 0; i < 15; ++i) {
+        wide.put(0x100000000ULL * i + 7, i);
+        narrow.put(1000u + i, i);
+    }
+    for (int i = 0; i < 15; ++i) {
+        ASSERT_NE(wide.find(0x100000000ULL * i + 7), nullptr) << i;
+        EXPECT_EQ(*wide.find(0x100000000ULL * i + 7), i);
+        EXPECT_EQ(narrow.get(1000u + i), i);
+    }
+    // Same low half as a stored key, different high half
+    EXPECT_FALSE(wide.contains(0x100000000ULL * 99 + 7));
+    EXPECT_FALSE(narrow.contains(999u));
+}
+
+TEST(StaticLRUCacheTest, IndexedCacheSurvivesChurn) {
+    StaticLRUCache<int, int, 100> cache;
+    for (int i = 0; i < 10000; ++i) {
+        cache.put(i % 357, i);
+        if (i % 3 == 0) cache.find(i % 50);
+    }
+    EXPECT_EQ(cache.size(), 100);
+
+    // Every entry on the recency list must be reachable through the index
+    size_t reachable = 0;
+    cache.for_each([&](const int& key, const int&) { reachable += cache.contains(key); });
+    EXPECT_EQ(reachable, 100);
+}
+
+TEST(StaticLRUCacheTest, StringKeys) {
+    StaticLRUCache<std::string, int, 32> cache;
+    for (int i = 0; i < 40; ++i) {
+        cache.put("key" + std::to_string(i), i);
+    }
+    EXPECT_FALSE(cache.contains("key7"));
+    EXPECT_EQ(cache.get("key39"), 39);
+    EXPECT_EQ(cache.get("key8"), 8);
+}
+
+TEST(StaticLRUCacheTest, Clear) {
+    StaticLRUCache<int, int, 20> cache;
+    for (int i = 0; i < 20; ++i) {
+        cache.put(i, i);
+    }
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_FALSE(cache.contains(5));
+
+    cache.put(5, 50);
+    EXPECT_EQ(cache.get(5), 50);
+}
@@ -0,0 +1,113 @@
+// tests/test_trace.cpp
+#include "../src/trace.hpp"
+#include "../src/hashtable.hpp"
+#include "../src/lru.hpp"
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+namespace {
+
+size_t count_of(const std::string& text, const std::string& needle) {
+    size_t count = 0;
+    for (size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1)) {
+        ++count;
+    }
+    return count;
+}
+
+std::string dump_trace() {
+    std::ostringstream out;
+    RingTrace::dump(out);
+    return out.str();
+}
+
+std::string event(const char* name, const char* phase) {
+    return std::string("\"name\":\"") + name + "\",\"cat\":\"cache\",\"ph\":\"" + phase + "\"";
+}
+
+// Every key hashes alike, so every insert probes past all earlier keys
+struct Colliding {
+    int id;
+    bool operator==(const Colliding& other) const { return id == other.id; }
+};
+
+} // namespace
+
+template <>
+struct std::hash<Colliding> {
+    size_t operator()(const Colliding&) const { return 42; }
+};
+
+TEST(TraceTest, RecordsCacheEvents) {
+    RingTrace::reset();
+    LRUCache<int, int, DefaultAllocator, RingTrace> cache(100);
+    for (int i = 0; i < 1000; ++i) {
+        cache.put(i, i);
+    }
+    std::string trace = dump_trace();
+    EXPECT_EQ(trace.rfind("{\"traceEvents\":[", 0), 0);
+    EXPECT_NE(trace.find("\"displayTimeUnit\":\"ns\"}"), std::string::npos);
+
+    EXPECT_EQ(count_of(trace, event("put", "B")), 1000);
+    EXPECT_EQ(count_of(trace, event("put", "E")), 1000);
+    EXPECT_EQ(count_of(trace, event("evict", "B")), 900);
+    EXPECT_GT(count_of(trace, event("grow", "B")), 0);
+    EXPECT_GT(count_of(trace, event("rehash", "B")), 0);
+    EXPECT_EQ(count_of(trace, event("rehash", "B")), count_of(trace, event("rehash", "E")));
+    EXPECT_GT(count_of(trace, event("allocate", "B")), 0);
+    EXPECT_GT(count_of(trace, event("migrate", "b")), 0);
+}
+
+TEST(TraceTest, ReportsLongProbes) {
+    RingTrace::reset();
+    HashTable<Colliding, int, DefaultAllocator, RingTrace> table;
+    for (int i = 0; i < 40; ++i) {
+        table.insert(Colliding{ i }, i);
+    }
+    std::string trace = dump_trace();
+    EXPECT_GT(count_of(trace, event("long_probe", "i")), 0);
+    EXPECT_NE(trace.find("\"args\":{\"value\":39}"), std::string::npos);
+
+    RingTrace::reset();
+    EXPECT_EQ(count_of(dump_trace(), "\"name\""), 0);
+}
+
+TEST(TraceTest, OneRingPerThread) {
+    RingTrace::reset();
+    auto work = [] {
+        LRUCache<int, int, DefaultAllocator, RingTrace> cache(4);
+        for (int i = 0; i < 10; ++i) {
+            cache.put(i, i);
+        }
+    };
+    std::thread a(work);
+    std::thread b(work);
+    a.join();
+    b.join();
+    std::string trace = dump_trace();
+    EXPECT_EQ(count_of(trace, event("put", "B")), 20);
+    EXPECT_EQ(count_of(trace, event("evict", "B")), 12);
+}
+
+TEST(TraceTest, RingKeepsTheLatestEvents) {
+    RingTrace::reset();
+    std::thread writer([] {
+        for (size_t i = 0; i < RingTrace::kCapacity + 10; ++i) {
+            RingTrace::instant(TraceEvent::LongProbe, i);
+        }
+    });
+    writer.join();
+    std::string trace = dump_trace();
+    EXPECT_EQ(count_of(trace, event("long_probe", "i")), RingTrace::kCapacity);
+    EXPECT_EQ(trace.find("\"args\":{\"value\":9}"), std::string::npos);
+    EXPECT_NE(trace.find("\"args\":{\"value\":10}"), std::string::npos);
+}
+
+TEST(TraceTest, NoTraceIsTheDefault) {
+    static_assert(!NoTrace::enabled, "NoTrace must compile tracing out");
+    static_assert(std::is_same_v<LRUCache<int, int>, LRUCache<int, int, DefaultAllocator, NoTrace>>);
+    static_assert(std::is_empty_v<TraceScope<NoTrace>>);
+}